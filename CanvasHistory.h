@@ -0,0 +1,295 @@
+#pragma once
+#include "raylib_win32.h"
+#include "TiledCanvas.h"
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Undo/redo for the drawing canvas, built on tile snapshots.
+//
+// The canvas is split into 128x128 world tiles. The first time an edit (a stroke, an erase)
+// reaches a tile, the tile is copied before anything is drawn over it. When the edit
+// ends, every tile it touched is copied again. Undo writes the "before" copies back and
+// redo writes the "after" copies, so both cost time in proportion to the edit's
+// footprint and not to the length of the history.
+//
+// Copies live in one render-texture atlas on the GPU. The atlas is a ring with a fixed
+// number of slots, sized from the memory limit. Slots are handed out in order, and
+// when the ring wraps the oldest edits lose their copies and can no longer be undone.
+// Copying is a textured quad drawn with blending off, so no pixels pass through the CPU.
+//
+// A history tile is a quarter of a TiledCanvas tile. Each copy takes one slot per
+// canvas layer, and undo and redo put every layer back together.
+//--------------------------------------------------------------------------------------
+class CanvasHistory {
+public:
+    static constexpr int TileSize = 128;
+    static constexpr int AtlasColumns = 32;
+    static constexpr int MaxSlots = AtlasColumns * 64;
+    static constexpr int Layers = TiledCanvas::Layers;
+    static_assert(TiledCanvas::TileSize % TileSize == 0, "history tiles must nest in canvas tiles");
+
+    // The canvas must outlive the history (or the next Load)
+    void Load(TiledCanvas* tiledCanvas, size_t memoryBytes) {
+        Unload();
+        canvas = tiledCanvas;
+
+        size_t tileBytes = (size_t)TileSize * TileSize * 4;
+        slots = (int)std::clamp<size_t>(memoryBytes / tileBytes, 0, MaxSlots);
+        if (slots < 2 * Layers) return; // history off
+
+        int columns = std::min(slots, AtlasColumns);
+        int rows = (slots + columns - 1) / columns;
+        atlas = LoadRenderTexture(columns * TileSize, rows * TileSize);
+        loaded = true;
+    }
+
+    void Unload() {
+        if (loaded) UnloadRenderTexture(atlas);
+        loaded = false;
+        entries.clear();
+        cursor = 0;
+        recording = false;
+        overrun = false;
+        pendingBefore.clear();
+    }
+
+    bool Enabled() const { return loaded; }
+    bool CanUndo() const { return cursor > 0 && !recording; }
+    bool CanRedo() const { return cursor < entries.size() && !recording; }
+    size_t UndoSteps() const { return cursor; }
+    size_t RedoSteps() const { return entries.size() - cursor; }
+    int Slots() const { return slots; }
+    // Tile copies held by history (oldest edits included until the ring overwrites them)
+    size_t SlotsUsed() const {
+        return entries.empty() ? 0 : (size_t)std::min<uint64_t>(next - entries.front().first, (uint64_t)slots);
+    }
+
+    // Forgets everything, e.g. after the canvas is wiped
+    void Clear() {
+        entries.clear();
+        cursor = 0;
+        recording = false;
+        overrun = false;
+        pendingBefore.clear();
+        touched.clear();
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Recording an edit
+    //--------------------------------------------------------------------------------------
+    void BeginEdit() {
+        if (!loaded) return;
+
+        // A new edit ends the redo branch; its slots are the newest, so hand them back
+        if (cursor < entries.size()) {
+            next = entries[cursor].first;
+            entries.resize(cursor);
+        }
+
+        entries.push_back({ next, {} });
+        recording = true;
+    }
+
+    // Marks every tile that the world rectangle overlaps. Tiles the edit hasn't reached
+    // yet are queued for a "before" copy, which SnapshotBefore() takes.
+    void Touch(float x0, float y0, float x1, float y1) {
+        if (!recording) return;
+
+        int tx0 = (int)floorf(x0 / TileSize), ty0 = (int)floorf(y0 / TileSize);
+        int tx1 = (int)floorf(x1 / TileSize), ty1 = (int)floorf(y1 / TileSize);
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) {
+                if (!touched.insert(TiledCanvas::Key(0, tx, ty)).second) continue;
+                pendingBefore.push_back({ tx, ty, 0, 0 });
+            }
+        }
+    }
+
+    // Copies the newly touched tiles out of the canvas. Call before drawing into it.
+    void SnapshotBefore() {
+        if (pendingBefore.empty()) return;
+        if (overrun) {
+            pendingBefore.clear();
+            return;
+        }
+
+        Entry& e = entries.back();
+        AcquireSources(pendingBefore);
+        BeginCopy();
+        for (size_t i = 0; i < pendingBefore.size(); i++) {
+            TileCopy& tile = pendingBefore[i];
+            tile.before = Allocate();
+            CopyToSlots(i, tile.before);
+            e.tiles.push_back(tile);
+        }
+        EndCopy();
+        pendingBefore.clear();
+        CheckOverrun();
+    }
+
+    // Copies the final state of every touched tile and files the edit as one undo step.
+    // An edit that never reached the canvas still gets its (empty) step, so the caller's
+    // own record of edits stays one to one with the steps.
+    void EndEdit() {
+        if (!recording) return;
+        recording = false;
+
+        touched.clear();
+        if (overrun) {
+            overrun = false;
+            return;
+        }
+
+        Entry& e = entries.back();
+        if (!e.tiles.empty()) {
+            AcquireSources(e.tiles);
+            BeginCopy();
+            for (size_t i = 0; i < e.tiles.size(); i++) {
+                TileCopy& tile = e.tiles[i];
+                tile.after = Allocate();
+                CopyToSlots(i, tile.after);
+            }
+            EndCopy();
+        }
+        cursor = entries.size();
+        CheckOverrun();
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Undo / redo
+    //--------------------------------------------------------------------------------------
+    bool Undo() {
+        if (!CanUndo()) return false;
+        const Entry& e = entries[--cursor];
+        Restore(e, true);
+        return true;
+    }
+
+    bool Redo() {
+        if (!CanRedo()) return false;
+        const Entry& e = entries[cursor++];
+        Restore(e, false);
+        return true;
+    }
+
+private:
+    struct TileCopy {
+        int tx, ty;
+        uint64_t before, after; // ring positions of the two copies of the first layer; later layers follow
+    };
+
+    struct Entry {
+        uint64_t first;         // ring position of the edit's first copy
+        std::vector<TileCopy> tiles;
+    };
+
+    uint64_t Allocate() {
+        uint64_t position = next;
+        next += Layers;
+        return position;
+    }
+
+    // Drops edits whose copies the ring has started to overwrite. If that reaches the
+    // edit being recorded, it is bigger than the whole ring; nothing older can be put
+    // back correctly underneath it either, so the whole history goes.
+    void CheckOverrun() {
+        uint64_t oldest = next > (uint64_t)slots ? next - slots : 0;
+        size_t dropped = 0;
+        while (dropped < entries.size() && entries[dropped].first < oldest) dropped++;
+        if (dropped == 0) return;
+
+        if (recording && dropped == entries.size()) {
+            entries.clear();
+            cursor = 0;
+            overrun = true;
+            return;
+        }
+        entries.erase(entries.begin(), entries.begin() + dropped);
+        cursor = cursor > dropped ? cursor - dropped : 0;
+    }
+
+    void Restore(const Entry& e, bool before) {
+        for (const TileCopy& tile : e.tiles) {
+            Rectangle area;
+            RenderTexture2D* layers = Source(tile.tx, tile.ty, area);
+            for (int layer = 0; layer < Layers; layer++) {
+                BeginTextureMode(layers[layer]);
+                BeginOverwrite();
+                Rectangle slot = SlotArea((before ? tile.before : tile.after) + layer);
+                DrawTexturePro(atlas.texture, Flipped(slot, (float)atlas.texture.height), area, { 0, 0 }, 0.0f, WHITE);
+                EndBlendMode();
+                EndTextureMode();
+            }
+            canvas->Changed(TiledCanvas::TileOf((float)(tile.tx * TileSize)), TiledCanvas::TileOf((float)(tile.ty * TileSize)));
+        }
+    }
+
+    // The canvas tile's layers holding a history tile, and the tile's area within them
+    RenderTexture2D* Source(int tx, int ty, Rectangle& area) {
+        float x = (float)(tx * TileSize), y = (float)(ty * TileSize);
+        int cx = TiledCanvas::TileOf(x), cy = TiledCanvas::TileOf(y);
+        area = { x - cx * TiledCanvas::TileSize, y - cy * TiledCanvas::TileSize, (float)TileSize, (float)TileSize };
+        return canvas->Acquire(cx, cy);
+    }
+
+    // Canvas tiles can't be created while the atlas is bound, so they are fetched first
+    void AcquireSources(const std::vector<TileCopy>& copies) {
+        sources.resize(copies.size());
+        areas.resize(copies.size());
+        for (size_t i = 0; i < copies.size(); i++)
+            sources[i] = Source(copies[i].tx, copies[i].ty, areas[i]);
+    }
+
+    void BeginCopy() {
+        BeginTextureMode(atlas);
+        BeginOverwrite();
+    }
+
+    void EndCopy() {
+        EndBlendMode();
+        EndTextureMode();
+    }
+
+    // Straight copy including alpha: source * 1 + destination * 0
+    static void BeginOverwrite() {
+        rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+        BeginBlendMode(BLEND_CUSTOM);
+    }
+
+    // Copies the i-th acquired source into consecutive slots, one per layer
+    void CopyToSlots(size_t i, uint64_t position) {
+        for (int layer = 0; layer < Layers; layer++) {
+            const Texture2D& source = sources[i][layer].texture;
+            DrawTexturePro(source, Flipped(areas[i], (float)source.height), SlotArea(position + layer), { 0, 0 }, 0.0f, WHITE);
+        }
+    }
+
+    Rectangle SlotArea(uint64_t position) const {
+        int slot = (int)(position % (uint64_t)slots);
+        return { (float)(slot % AtlasColumns * TileSize), (float)(slot / AtlasColumns * TileSize), (float)TileSize, (float)TileSize };
+    }
+
+    // Render textures are stored bottom-up, so reading a screen-space rectangle back
+    // out of one means sampling it mirrored
+    static Rectangle Flipped(Rectangle r, float textureHeight) {
+        return { r.x, textureHeight - r.y - r.height, r.width, -r.height };
+    }
+
+    TiledCanvas* canvas = nullptr;
+    int slots = 0;
+    RenderTexture2D atlas = {};
+    bool loaded = false;
+
+    std::vector<Entry> entries;        // oldest first
+    size_t cursor = 0;                 // entries[0, cursor) are on the canvas
+    uint64_t next = 0;                 // next ring position to hand out
+    bool recording = false;
+    bool overrun = false;              // the edit being recorded outgrew the ring
+    std::unordered_set<uint64_t> touched; // tiles reached by the edit being recorded
+    std::vector<TileCopy> pendingBefore;
+    std::vector<RenderTexture2D*> sources; // canvas layers per copy, see AcquireSources()
+    std::vector<Rectangle> areas;
+};
@@ -32,6 +32,15 @@ struct SandSimulationConfig {
 	float SettleThreshold = 5.0f; // seconds
 };
 
+// A background snow layer: cheaper flakes that never settle, stepped every
+// UpdateDivisor frames and drawn into a RenderScale-sized buffer that is upscaled.
+struct SnowLayerConfig {
+	float SpawnInterval = 0.01f;  // seconds between spawns
+	int UpdateDivisor = 1;        // physics steps every N frames, interpolated in between
+	float RenderScale = 1.0f;     // buffer resolution relative to the screen
+	float Depth = 1.0f;           // size, speed and brightness relative to the near layer
+};
+
 struct SnowSimulationConfig {
 	int MinFlakeSize = 1;
 	int MaxFlakeSize = 6;
@@ -40,6 +49,57 @@ struct SnowSimulationConfig {
 	float FadeSpeed = 0.05f;           // alpha drop per second
 	float MouseAvoidRadius = 75.0f;         // mouse avoid radius
 	float MouseAvoidStrength = 6.0f;        // mouse avoidance force
+	int DriftSlope = 2;                     // max depth step between columns before snow slides (0 = off)
+	float WindFieldCellSize = 64.0f;        // pixels per wind field cell
+	float WindFieldUpdateRate = 10.0f;      // wind field rebuilds per second
+	float WindFieldStrength = 0.5f;         // peak eddy wind, same scale as gusts
+
+	// Parallax layers behind the settling near layer
+	SnowLayerConfig FarLayer = { 0.004f, 4, 0.25f, 0.35f };
+	SnowLayerConfig MidLayer = { 0.008f, 2, 0.5f, 0.6f };
+};
+
+// A firework shell type. Pattern picks the burst shape (peony, ring, crossette or palm);
+// a willow is a peony with heavy drag, low gravity and long-lived sparks.
+struct ShellTypeConfig {
+	std::string Name = "peony";
+	std::string Pattern = "peony";
+	int SparkCount = 48;
+	float Speed = 210.0f;         // pixels per second at burst
+	float Life = 1.6f;            // seconds
+	float Drag = 0.4f;            // fraction of velocity kept after one second
+	float Gravity = 90.0f;        // downward acceleration, pixels per second squared
+	float SplitTime = 0.0f;       // crossette fuse in seconds (0 = never splits)
+	std::vector<Color> Colors;    // cycled across the burst, empty = random per spark
+};
+
+struct FireworksSimulationConfig {
+	int MaxSparks = 16384;        // spark pool capacity, allocated once
+	float LaunchRate = 0.6f;      // automatic launches per second
+	float RocketFlightTime = 1.0f; // seconds from launch to burst
+	float RocketGravity = 540.0f; // pixels per second squared
+	std::string ShowFile = "";    // timeline to play instead of random launches (see ShowTimeline.h)
+	bool ShowLoop = true;         // restart the show when it ends
+	int WorkerThreads = -1;       // update threads besides the main one (-1 = one per extra core)
+	bool GroundCollision = true;  // sparks bounce off the floor (taskbar top when TaskbarAware)
+	float GroundBounce = 0.4f;    // vertical speed kept per bounce
+	float GroundFriction = 0.7f;  // horizontal speed kept per bounce
+	int LodSparkThreshold = 8192; // live sparks before trail detail and culling stretch (not physics)
+	float LodReducedLife = 0.6f;  // seconds left when a spark drops to half its trail
+	float LodMinimalLife = 0.25f; // seconds left when only the core is drawn
+	float LodCullLife = 0.08f;    // seconds left when a spark is culled
+	float GlowScale = 0.25f;      // glow buffer resolution relative to the screen (0 = off)
+	int GlowRadius = 2;           // box blur radius in glow texels
+	int GlowPasses = 2;           // box blur passes
+	float GlowIntensity = 0.6f;   // light each spark adds
+
+	std::vector<ShellTypeConfig> ShellTypes = {
+		{ "peony",     "peony",     48, 210.0f, 1.6f, 0.4f,  90.0f,  0.0f, {} },
+		{ "ring",      "ring",      36, 240.0f, 1.4f, 0.3f,  72.0f,  0.0f, { { 102, 191, 255, 255 }, { 255, 255, 255, 255 } } },
+		{ "willow",    "peony",     60, 150.0f, 3.0f, 0.09f, 36.0f,  0.0f, { { 255, 200, 80, 255 }, { 255, 170, 40, 255 } } },
+		{ "crossette", "crossette", 12, 240.0f, 1.6f, 0.4f,  90.0f,  0.5f, { { 255, 255, 255, 255 }, { 255, 109, 194, 255 } } },
+		{ "palm",      "palm",      8,  300.0f, 1.8f, 0.22f, 108.0f, 0.0f, { { 255, 161, 0, 255 }, { 255, 220, 120, 255 } } }
+	};
 };
 
 struct DrawingSimulationConfig {
@@ -47,6 +107,10 @@ struct DrawingSimulationConfig {
 	int minBrushSize = 1;
 	int maxBrushSize = 50;
 	float highlighterAlpha = 0.4f;
+	int historyMemoryMB = 32; // undo/redo tile copies, oldest strokes drop out past this
+	float simplifyTolerance = 0.75f; // px a stored stroke may stray from the sampled path
+	int tileMemoryMB = 256; // canvas tiles kept on the GPU, colder ones are spilled to disk
+	std::string documentFile = "drawing.dstk"; // strokes saved across runs, "" = don't save
 
 	// Preset color palette
 	std::vector<Color> presetColors = { RED, GREEN, BLUE, YELLOW, PURPLE, ORANGE, PINK, SKYBLUE, DARKGREEN, WHITE };
@@ -61,6 +125,7 @@ struct Config {
 	ActiveSimulation ActiveSim = ActiveSimulation::Sand;
 	SnowSimulationConfig SnowSimConfig = {};
 	SandSimulationConfig SandSimConfig = {};
+	FireworksSimulationConfig FireworksSimConfig = {};
 	DrawingSimulationConfig DrawingSimConfig = {};
 };
 
@@ -95,6 +160,18 @@ public:
 		j["SnowSimConfig"]["FadeSpeed"] = config.SnowSimConfig.FadeSpeed;
 		j["SnowSimConfig"]["MouseAvoidRadius"] = config.SnowSimConfig.MouseAvoidRadius;
 		j["SnowSimConfig"]["MouseAvoidStrength"] = config.SnowSimConfig.MouseAvoidStrength;
+		j["SnowSimConfig"]["DriftSlope"] = config.SnowSimConfig.DriftSlope;
+		j["SnowSimConfig"]["WindFieldCellSize"] = config.SnowSimConfig.WindFieldCellSize;
+		j["SnowSimConfig"]["WindFieldUpdateRate"] = config.SnowSimConfig.WindFieldUpdateRate;
+		j["SnowSimConfig"]["WindFieldStrength"] = config.SnowSimConfig.WindFieldStrength;
+		j["SnowSimConfig"]["FarLayer"]["SpawnInterval"] = config.SnowSimConfig.FarLayer.SpawnInterval;
+		j["SnowSimConfig"]["FarLayer"]["UpdateDivisor"] = config.SnowSimConfig.FarLayer.UpdateDivisor;
+		j["SnowSimConfig"]["FarLayer"]["RenderScale"] = config.SnowSimConfig.FarLayer.RenderScale;
+		j["SnowSimConfig"]["FarLayer"]["Depth"] = config.SnowSimConfig.FarLayer.Depth;
+		j["SnowSimConfig"]["MidLayer"]["SpawnInterval"] = config.SnowSimConfig.MidLayer.SpawnInterval;
+		j["SnowSimConfig"]["MidLayer"]["UpdateDivisor"] = config.SnowSimConfig.MidLayer.UpdateDivisor;
+		j["SnowSimConfig"]["MidLayer"]["RenderScale"] = config.SnowSimConfig.MidLayer.RenderScale;
+		j["SnowSimConfig"]["MidLayer"]["Depth"] = config.SnowSimConfig.MidLayer.Depth;
 		j["SandSimConfig"]["BrushRadius"] = config.SandSimConfig.BrushRadius;
 		j["SandSimConfig"]["MaxDensity"] = config.SandSimConfig.MaxDensity;
 		j["SandSimConfig"]["HueCycleSpeed"] = config.SandSimConfig.HueCycleSpeed;
@@ -106,20 +183,52 @@ public:
 		j["SandSimConfig"]["MaxFallSpeed"] = config.SandSimConfig.MaxFallSpeed;
 		j["SandSimConfig"]["AirResistance"] = config.SandSimConfig.AirResistance;
 		j["SandSimConfig"]["SettleThreshold"] = config.SandSimConfig.SettleThreshold;
+		j["FireworksSimConfig"]["MaxSparks"] = config.FireworksSimConfig.MaxSparks;
+		j["FireworksSimConfig"]["LaunchRate"] = config.FireworksSimConfig.LaunchRate;
+		j["FireworksSimConfig"]["RocketFlightTime"] = config.FireworksSimConfig.RocketFlightTime;
+		j["FireworksSimConfig"]["RocketGravity"] = config.FireworksSimConfig.RocketGravity;
+		j["FireworksSimConfig"]["ShowFile"] = config.FireworksSimConfig.ShowFile;
+		j["FireworksSimConfig"]["ShowLoop"] = config.FireworksSimConfig.ShowLoop;
+		j["FireworksSimConfig"]["WorkerThreads"] = config.FireworksSimConfig.WorkerThreads;
+		j["FireworksSimConfig"]["GroundCollision"] = config.FireworksSimConfig.GroundCollision;
+		j["FireworksSimConfig"]["GroundBounce"] = config.FireworksSimConfig.GroundBounce;
+		j["FireworksSimConfig"]["GroundFriction"] = config.FireworksSimConfig.GroundFriction;
+		j["FireworksSimConfig"]["LodSparkThreshold"] = config.FireworksSimConfig.LodSparkThreshold;
+		j["FireworksSimConfig"]["LodReducedLife"] = config.FireworksSimConfig.LodReducedLife;
+		j["FireworksSimConfig"]["LodMinimalLife"] = config.FireworksSimConfig.LodMinimalLife;
+		j["FireworksSimConfig"]["LodCullLife"] = config.FireworksSimConfig.LodCullLife;
+		j["FireworksSimConfig"]["GlowScale"] = config.FireworksSimConfig.GlowScale;
+		j["FireworksSimConfig"]["GlowRadius"] = config.FireworksSimConfig.GlowRadius;
+		j["FireworksSimConfig"]["GlowPasses"] = config.FireworksSimConfig.GlowPasses;
+		j["FireworksSimConfig"]["GlowIntensity"] = config.FireworksSimConfig.GlowIntensity;
+		j["FireworksSimConfig"]["ShellTypes"] = json::array();
+		for (const auto& shell : config.FireworksSimConfig.ShellTypes) {
+			json s;
+			s["Name"] = shell.Name;
+			s["Pattern"] = shell.Pattern;
+			s["SparkCount"] = shell.SparkCount;
+			s["Speed"] = shell.Speed;
+			s["Life"] = shell.Life;
+			s["Drag"] = shell.Drag;
+			s["Gravity"] = shell.Gravity;
+			s["SplitTime"] = shell.SplitTime;
+			s["Colors"] = json::array();
+			for (const auto& c : shell.Colors)
+				s["Colors"].push_back(ColorToString(c));
+			j["FireworksSimConfig"]["ShellTypes"].push_back(s);
+		}
 		j["DrawingSimConfig"]["defaultBrushSize"] = config.DrawingSimConfig.defaultBrushSize;
 		j["DrawingSimConfig"]["minBrushSize"] = config.DrawingSimConfig.minBrushSize;
 		j["DrawingSimConfig"]["maxBrushSize"] = config.DrawingSimConfig.maxBrushSize;
 		j["DrawingSimConfig"]["highlighterAlpha"] = config.DrawingSimConfig.highlighterAlpha;
+		j["DrawingSimConfig"]["historyMemoryMB"] = config.DrawingSimConfig.historyMemoryMB;
+		j["DrawingSimConfig"]["simplifyTolerance"] = config.DrawingSimConfig.simplifyTolerance;
+		j["DrawingSimConfig"]["tileMemoryMB"] = config.DrawingSimConfig.tileMemoryMB;
+		j["DrawingSimConfig"]["documentFile"] = config.DrawingSimConfig.documentFile;
 		j["DrawingSimConfig"]["presetColors"] = json::array();
 
 		for (const auto& c : config.DrawingSimConfig.presetColors) {
-			std::string colorStr =
-				std::to_string(c.r) + "," +
-				std::to_string(c.g) + "," +
-				std::to_string(c.b) + "," +
-				std::to_string(c.a);
-
-			j["DrawingSimConfig"]["presetColors"].push_back(colorStr);
+			j["DrawingSimConfig"]["presetColors"].push_back(ColorToString(c));
 		}
 
 		std::ofstream file(config_file_path);
@@ -148,6 +257,21 @@ public:
 				config.SnowSimConfig.FadeSpeed = j["SnowSimConfig"].value("FadeSpeed", 0.05f);
 				config.SnowSimConfig.MouseAvoidRadius = j["SnowSimConfig"].value("MouseAvoidRadius", 75.0f);
 				config.SnowSimConfig.MouseAvoidStrength = j["SnowSimConfig"].value("MouseAvoidStrength", 6.0f);
+				config.SnowSimConfig.DriftSlope = j["SnowSimConfig"].value("DriftSlope", 2);
+				config.SnowSimConfig.WindFieldCellSize = j["SnowSimConfig"].value("WindFieldCellSize", 64.0f);
+				config.SnowSimConfig.WindFieldUpdateRate = j["SnowSimConfig"].value("WindFieldUpdateRate", 10.0f);
+				config.SnowSimConfig.WindFieldStrength = j["SnowSimConfig"].value("WindFieldStrength", 0.5f);
+				// Configs from before the parallax layers have no layer objects
+				const json farLayer = j["SnowSimConfig"].value("FarLayer", json::object());
+				const json midLayer = j["SnowSimConfig"].value("MidLayer", json::object());
+				config.SnowSimConfig.FarLayer.SpawnInterval = farLayer.value("SpawnInterval", 0.004f);
+				config.SnowSimConfig.FarLayer.UpdateDivisor = farLayer.value("UpdateDivisor", 4);
+				config.SnowSimConfig.FarLayer.RenderScale = farLayer.value("RenderScale", 0.25f);
+				config.SnowSimConfig.FarLayer.Depth = farLayer.value("Depth", 0.35f);
+				config.SnowSimConfig.MidLayer.SpawnInterval = midLayer.value("SpawnInterval", 0.008f);
+				config.SnowSimConfig.MidLayer.UpdateDivisor = midLayer.value("UpdateDivisor", 2);
+				config.SnowSimConfig.MidLayer.RenderScale = midLayer.value("RenderScale", 0.5f);
+				config.SnowSimConfig.MidLayer.Depth = midLayer.value("Depth", 0.6f);
 				config.SandSimConfig.BrushRadius = j["SandSimConfig"].value("BrushRadius", 10.0f);
 				config.SandSimConfig.MaxDensity = j["SandSimConfig"].value("MaxDensity", 30);
 				config.SandSimConfig.HueCycleSpeed = j["SandSimConfig"].value("HueCycleSpeed", 2.0f);
@@ -159,16 +283,61 @@ public:
 				config.SandSimConfig.MaxFallSpeed = j["SandSimConfig"].value("MaxFallSpeed", 5.0f);
 				config.SandSimConfig.AirResistance = j["SandSimConfig"].value("AirResistance", 0.99f);
 				config.SandSimConfig.SettleThreshold = j["SandSimConfig"].value("SettleThreshold", 5.0f);
+				// Configs from before the fireworks settings have no section for them
+				const json fireworks = j.value("FireworksSimConfig", json::object());
+				config.FireworksSimConfig.MaxSparks = fireworks.value("MaxSparks", 16384);
+				config.FireworksSimConfig.LaunchRate = fireworks.value("LaunchRate", 0.6f);
+				config.FireworksSimConfig.RocketFlightTime = fireworks.value("RocketFlightTime", 1.0f);
+				config.FireworksSimConfig.RocketGravity = fireworks.value("RocketGravity", 540.0f);
+				config.FireworksSimConfig.ShowFile = fireworks.value("ShowFile", std::string(""));
+				config.FireworksSimConfig.ShowLoop = fireworks.value("ShowLoop", true);
+				config.FireworksSimConfig.WorkerThreads = fireworks.value("WorkerThreads", -1);
+				config.FireworksSimConfig.GroundCollision = fireworks.value("GroundCollision", true);
+				config.FireworksSimConfig.GroundBounce = fireworks.value("GroundBounce", 0.4f);
+				config.FireworksSimConfig.GroundFriction = fireworks.value("GroundFriction", 0.7f);
+				config.FireworksSimConfig.LodSparkThreshold = fireworks.value("LodSparkThreshold", 8192);
+				config.FireworksSimConfig.LodReducedLife = fireworks.value("LodReducedLife", 0.6f);
+				config.FireworksSimConfig.LodMinimalLife = fireworks.value("LodMinimalLife", 0.25f);
+				config.FireworksSimConfig.LodCullLife = fireworks.value("LodCullLife", 0.08f);
+				config.FireworksSimConfig.GlowScale = fireworks.value("GlowScale", 0.25f);
+				config.FireworksSimConfig.GlowRadius = fireworks.value("GlowRadius", 2);
+				config.FireworksSimConfig.GlowPasses = fireworks.value("GlowPasses", 2);
+				config.FireworksSimConfig.GlowIntensity = fireworks.value("GlowIntensity", 0.6f);
+				if (fireworks.contains("ShellTypes")) {
+					config.FireworksSimConfig.ShellTypes.clear();
+					for (const auto& s : fireworks["ShellTypes"]) {
+						ShellTypeConfig shell;
+						shell.Name = s.value("Name", std::string("peony"));
+						shell.Pattern = s.value("Pattern", std::string("peony"));
+						shell.SparkCount = s.value("SparkCount", 48);
+						shell.Speed = s.value("Speed", 210.0f);
+						shell.Life = s.value("Life", 1.6f);
+						shell.Drag = s.value("Drag", 0.4f);
+						shell.Gravity = s.value("Gravity", 90.0f);
+						shell.SplitTime = s.value("SplitTime", 0.0f);
+						if (s.contains("Colors")) {
+							for (const auto& colorStr : s["Colors"]) {
+								Color c;
+								if (ParseColor(colorStr.get<std::string>(), c))
+									shell.Colors.push_back(c);
+							}
+						}
+						config.FireworksSimConfig.ShellTypes.push_back(shell);
+					}
+				}
 				config.DrawingSimConfig.defaultBrushSize = j["DrawingSimConfig"].value("defaultBrushSize", 5);
 				config.DrawingSimConfig.minBrushSize = j["DrawingSimConfig"].value("minBrushSize", 1);
 				config.DrawingSimConfig.maxBrushSize = j["DrawingSimConfig"].value("maxBrushSize", 50);
 				config.DrawingSimConfig.highlighterAlpha = j["DrawingSimConfig"].value("highlighterAlpha", 0.4f);
+				config.DrawingSimConfig.historyMemoryMB = j["DrawingSimConfig"].value("historyMemoryMB", 32);
+				config.DrawingSimConfig.simplifyTolerance = j["DrawingSimConfig"].value("simplifyTolerance", 0.75f);
+				config.DrawingSimConfig.tileMemoryMB = j["DrawingSimConfig"].value("tileMemoryMB", 256);
+				config.DrawingSimConfig.documentFile = j["DrawingSimConfig"].value("documentFile", std::string("drawing.dstk"));
 				config.DrawingSimConfig.presetColors.clear();
 				for (const auto& colorStr : j["DrawingSimConfig"]["presetColors"]) {
-					std::string str = colorStr.get<std::string>();
-					int r, g, b, a;
-					if (sscanf_s(str.c_str(), "%d,%d,%d,%d", &r, &g, &b, &a) == 4) {
-						config.DrawingSimConfig.presetColors.push_back({ (unsigned char)r, (unsigned char)g, (unsigned char)b, (unsigned char)a });
+					Color c;
+					if (ParseColor(colorStr.get<std::string>(), c)) {
+						config.DrawingSimConfig.presetColors.push_back(c);
 					}
 				}
 
@@ -183,6 +352,21 @@ public:
 	}
 
 private:
+	// Colors are stored as "r,g,b,a" strings
+	static std::string ColorToString(const Color& c) {
+		return std::to_string(c.r) + "," +
+			std::to_string(c.g) + "," +
+			std::to_string(c.b) + "," +
+			std::to_string(c.a);
+	}
+
+	static bool ParseColor(const std::string& str, Color& out) {
+		int r, g, b, a;
+		if (sscanf_s(str.c_str(), "%d,%d,%d,%d", &r, &g, &b, &a) != 4) return false;
+		out = { (unsigned char)r, (unsigned char)g, (unsigned char)b, (unsigned char)a };
+		return true;
+	}
+
 	Config config;
 	int taskbar_height = 0;
 };
\ No newline at end of file
@@ -3,17 +3,36 @@
 #include "Helper.h"
 #include "Simulation.h"
 #include "Config.h"
+#include "StrokeMesh.h"
+#include "TiledCanvas.h"
+#include "CanvasHistory.h"
+#include "StrokeFilter.h"
+#include "StrokeDocument.h"
+#include "StrokeIndex.h"
+#include "PointerSampler.h"
 #include <vector>
+#include <deque>
 #include <string>
+#include <unordered_set>
+#include <filesystem>
 #include <algorithm>
 
 extern ConfigManager configManager;
 
-struct Stroke {
-    std::vector<Vector2> points;
-    Color color;
-    int brushSize;
-    bool highlighter;
+// Stroke segments waiting to be drawn into the canvas: the curve pieces ending at points
+// first..last (first == 0 also caps the starting point)
+struct StrokeRun {
+    size_t stroke;
+    size_t first, last;
+};
+
+// What one undo step did to the stroke list: a stroke added one stroke, an erase took
+// some away. `positions` (ascending) are where those strokes sit in the list when they
+// are on it, and `out` holds them while they are off it.
+struct StrokeEdit {
+    bool erase;
+    std::vector<size_t> positions;
+    std::vector<Stroke> out;
 };
 
 class DrawingSimulation : public ISimulation {
@@ -26,9 +45,72 @@ private:
     int colorIndex = 0;
 
     Config* config = nullptr;
-    RenderTexture2D canvas;
     bool canvasInitialized = false;
 
+    // The canvas has no edges: strokes are kept in world coordinates and drawn into
+    // tiles, layer 0 for ink and layer 1 for highlights. The camera's target is the
+    // world point at the window's top-left corner.
+    TiledCanvas tiles;
+    Camera2D camera = { { 0, 0 }, { 0, 0 }, 0.0f, 1.0f };
+    static constexpr float MinZoom = 1.0f / (1 << TiledCanvas::MaxLevel);
+    static constexpr float MaxZoom = 8.0f;
+
+    // Highlighter strokes go into their own layer in their full colour, where overlaps
+    // just cover the same pixels again. The layer is shown under the ink with the
+    // highlighter alpha, once per frame, so a highlight has the same strength however
+    // slowly it was drawn or however often it was gone over. While a highlighter stroke
+    // is being drawn, its live end is added to a screen-sized copy of the visible layer
+    // (the view) instead.
+    RenderTexture2D highlightView;
+    bool tailInView = false;
+
+    // Canvas work queued during Update() and flushed in one render-target pass
+    std::vector<StrokeRun> pendingRuns;
+    bool clearPending = false;
+    StrokeMesh mesh;
+    StrokeMesh highlightMesh;
+
+    // Undo/redo. Every canvas edit is one history step, and `edits` keeps what each step
+    // did to the stroke list so undo and redo can repeat it there.
+    CanvasHistory history;
+    std::deque<StrokeEdit> edits;  // oldest first, one per history step
+    bool strokeEnding = false;
+
+    // Object eraser: whole strokes under the cursor go, and only the tiles they covered
+    // are drawn again from the strokes that are left
+    StrokeIndex index;
+    uint32_t nextStrokeId = 1;
+    bool erasing = false;
+    Vector2 lastErase = { 0, 0 };
+    std::vector<uint32_t> hits;     // scratch
+    std::unordered_set<uint64_t> dirtyTile;       // history tiles, keyed as TiledCanvas tiles
+    std::vector<std::pair<int, int>> dirtyTiles;
+
+    // Samples are filtered before they're stored. A curve piece is final once the point
+    // after its end is known; the rest of the stroke up to the cursor is redrawn every
+    // frame on top of the canvas.
+    StrokeFilter filter;
+    size_t finalized = 0;          // last point of the stroke being drawn that is on the canvas
+    StrokeMesh tailMesh;
+    std::vector<Vector2> tail;
+    std::vector<Vector2> smoothed; // scratch
+    size_t sampledPoints = 0;
+    size_t storedPoints = 0;
+
+    // Strokes take every pointer sample since the last frame, not just the cursor at
+    // frame time, so they keep their shape at low frame rates and on fast flicks
+    PointerSampler sampler;
+    std::vector<PointerSample> samples;
+    size_t strokeSamples = 0;
+    double strokeStart = 0.0, strokeEnd = 0.0;
+    float inputRate = 0.0f;        // samples per second over the last stroke
+
+    // Saved drawing: read in the background at start, then kept up to date on disk
+    StrokeDocumentLoader loader;
+    StrokeDocumentWriter writer;
+    bool documentDirty = false;    // needs a full rewrite (undo, redo, erase, clear)
+    bool saving = false;           // the file was read (or is new) and may be written
+
 public:
     DrawingSimulation(const DrawingSimulationConfig& configOverride = {})
         : cfg(configOverride) {
@@ -42,20 +124,32 @@ public:
     }
 
     ~DrawingSimulation() {
+        // An edit still being held when the overlay closes
+        if (documentDirty && saving)
+            writer.Rewrite(cfg.documentFile, strokes);
         if (canvasInitialized) {
-            UnloadRenderTexture(canvas);
+            UnloadRenderTexture(highlightView);
+            history.Unload();
+            tiles.Unload();
         }
     }
 
     void InitCanvas() {
         if (!canvasInitialized) {
-            canvas = LoadRenderTexture(width, height);
             canvasInitialized = true;
-            SetTextureFilter(canvas.texture, TEXTURE_FILTER_BILINEAR);
-
-            BeginTextureMode(canvas);
-            ClearBackground({ 0,0,0,0 });
-            EndTextureMode();
+            highlightView = LoadRenderTexture(width, height);
+
+            tiles.Load((size_t)std::max(cfg.tileMemoryMB, 0) << 20, std::filesystem::temp_directory_path() / "DesktopOverlayTiles");
+            history.Load(&tiles, (size_t)std::max(cfg.historyMemoryMB, 0) << 20);
+            sampler.Start();
+
+            if (!cfg.documentFile.empty()) {
+                loader.Start(cfg.documentFile, [](const std::vector<Stroke>& loaded, StrokeMesh& ink, StrokeMesh& highlighted) {
+                    std::vector<Vector2> curve;
+                    for (const Stroke& stroke : loaded)
+                        AddStroke(stroke.highlighter ? highlighted : ink, stroke, StrokeColor(stroke), curve);
+                });
+            }
         }
     }
 
@@ -69,52 +163,347 @@ public:
         colorIndex = (colorIndex + dir + n) % n;
     }
 
-    void DrawStrokeSegment(const Stroke& stroke, size_t index, RenderTexture2D& canvas) {
-        if (index == 0 || index >= stroke.points.size()) return;
+    // Colour a stroke is drawn with in its layer; highlighter alpha is applied to the
+    // whole layer when it's shown
+    static Color StrokeColor(const Stroke& stroke) {
+        return stroke.highlighter
+            ? Color{ stroke.color.r, stroke.color.g, stroke.color.b, 255 }
+            : stroke.color;
+    }
 
-        Vector2 a = stroke.points[index - 1];
-        Vector2 b = stroke.points[index];
+    StrokeMesh& MeshFor(const Stroke& stroke) {
+        return stroke.highlighter ? highlightMesh : mesh;
+    }
 
-        BeginTextureMode(canvas);
+    // A whole stroke's geometry
+    static void AddStroke(StrokeMesh& out, const Stroke& stroke, Color color, std::vector<Vector2>& curve) {
+        if (stroke.points.empty()) return;
+        SmoothStroke(stroke.points.data(), stroke.points.size(), 0, stroke.points.size() - 1, curve);
+        out.AddRun(curve, 0, curve.size() - 1, (float)stroke.brushSize, color);
+    }
 
-        Color col = stroke.highlighter
-            ? Fade(stroke.color, cfg.highlighterAlpha)
-            : stroke.color;
+    // Queues the newest point of a stroke; extends the previous run when it belongs to
+    // the same stroke so a frame's worth of samples is drawn as one polyline
+    void QueuePoint(size_t stroke, size_t point) {
+        if (!pendingRuns.empty() && pendingRuns.back().stroke == stroke && pendingRuns.back().last + 1 == point) {
+            pendingRuns.back().last = point;
+            return;
+        }
+        pendingRuns.push_back({ stroke, point, point });
+    }
+
+    // Queues the curve pieces of the stroke being drawn up to points[upTo]
+    void QueueFinal(size_t upTo) {
+        for (size_t i = finalized + 1; i <= upTo; i++)
+            QueuePoint(strokes.size() - 1, i);
+        finalized = std::max(finalized, upTo);
+    }
 
-        float dx = b.x - a.x;
-        float dy = b.y - a.y;
-        float dist = sqrtf(dx * dx + dy * dy);
+    Vector2 ToWorld(Vector2 screen) const {
+        return GetScreenToWorld2D(screen, camera);
+    }
 
-        float step = stroke.brushSize * 0.25f;
-        int steps = (int)(dist / step);
-        if (steps < 1) steps = 1;
+    // Scales the view by `factor`, keeping the world point under `screen` in place
+    void ZoomAt(Vector2 screen, float factor) {
+        Vector2 anchor = ToWorld(screen);
+        camera.zoom = std::clamp(camera.zoom * factor, MinZoom, MaxZoom);
+        camera.target = { anchor.x - screen.x / camera.zoom, anchor.y - screen.y / camera.zoom };
+    }
 
-        for (int i = 0; i <= steps; i++) {
-            float t = i / (float)steps;
-            Vector2 p = { a.x + dx * t, a.y + dy * t };
-            DrawCircleV(p, (float)stroke.brushSize, col);
+    void AddPoint(Vector2 p) {
+        if (filter.Add(strokes.back().points, p))
+            QueueFinal(strokes.back().points.size() - 2);
+    }
+
+    // Adds the frame's samples from `from` on that were taken with the button down.
+    // Without the sampler there is one sample per frame, the cursor position.
+    void AddSamples(size_t from) {
+        if (!sampler.Running()) {
+            AddPoint(ToWorld(GetMousePosition()));
+            return;
+        }
+        for (size_t i = from; i < samples.size(); i++) {
+            if (!samples[i].down) continue;
+            AddPoint(ToWorld(samples[i].position));
+            if (strokeSamples++ == 0) strokeStart = samples[i].time;
+            strokeEnd = samples[i].time;
         }
+    }
 
+    // Tiles under a polyline, widened by the brush
+    void TouchPolyline(const std::vector<Vector2>& points, int brush) {
+        float r = brush + 1.0f;
+        for (size_t i = 0; i < points.size(); i++) {
+            Vector2 a = points[i > 0 ? i - 1 : 0];
+            Vector2 b = points[i];
+            history.Touch(std::min(a.x, b.x) - r, std::min(a.y, b.y) - r, std::max(a.x, b.x) + r, std::max(a.y, b.y) + r);
+        }
+    }
+
+    // Live end of the stroke being drawn: from its last final point through the points
+    // kept since and on to the newest sample
+    void BuildTail() {
+        tailMesh.Clear();
+        tailInView = false;
+        if (!drawing || strokes.empty()) return;
+
+        const Stroke& stroke = strokes.back();
+        size_t from = finalized > 0 ? finalized - 1 : 0; // one point back for the curve's tangent
+        tail.assign(stroke.points.begin() + from, stroke.points.end());
+        if (filter.HasPending()) tail.push_back(filter.Last());
+
+        size_t first = finalized - from + 1;
+        if (tail.size() <= first) return;
+        SmoothStroke(tail.data(), tail.size(), first, tail.size() - 1, smoothed);
+        tailMesh.AddRun(smoothed, 1, smoothed.size() - 1, (float)stroke.brushSize, StrokeColor(stroke));
+        if (stroke.highlighter) BuildHighlightView();
+    }
+
+    // The visible part of the highlighter layer with the live end of the stroke merged
+    // into it, so the two don't overlap when shown
+    void BuildHighlightView() {
+        BeginTextureMode(highlightView);
+        ClearBackground({ 0,0,0,0 });
+        BeginMode2D(camera);
+        rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD); // straight copy, alpha included
+        BeginBlendMode(BLEND_CUSTOM);
+        tiles.DrawView(1, camera, width, height, WHITE);
+        EndBlendMode();
+        tailMesh.Draw();
+        EndMode2D();
         EndTextureMode();
+        tailMesh.Clear();
+        tailInView = true;
     }
 
-    void DrawStrokeEndCap(const Stroke& stroke, RenderTexture2D& canvas) {
-        if (stroke.points.empty()) return;
-        Vector2 end = stroke.points.back();
+    // The frame's only bind of each tile the new runs reach; does nothing when no stroke
+    // work is queued. History copies are taken around it: tiles first reached this frame
+    // before drawing, and the whole stroke's tiles after its last points are in.
+    void FlushCanvas() {
+        if (pendingRuns.empty() && !clearPending && !strokeEnding) return;
+
+        mesh.Clear();
+        highlightMesh.Clear();
+        for (const StrokeRun& run : pendingRuns) {
+            if (run.stroke >= strokes.size()) continue;
+            const Stroke& stroke = strokes[run.stroke];
+            SmoothStroke(stroke.points.data(), stroke.points.size(), run.first, run.last, smoothed);
+            TouchPolyline(smoothed, stroke.brushSize);
+            MeshFor(stroke).AddRun(smoothed, run.first == 0 ? 0 : 1, smoothed.size() - 1, (float)stroke.brushSize, StrokeColor(stroke));
+        }
+        history.SnapshotBefore();
 
-        BeginTextureMode(canvas);
+        if (clearPending) tiles.Clear();
+        tiles.Draw(0, mesh);
+        tiles.Draw(1, highlightMesh);
 
-        Color col = stroke.highlighter
-            ? Fade(stroke.color, cfg.highlighterAlpha)
-            : stroke.color;
+        if (strokeEnding) EndEdit();
 
-        DrawCircleV(end, (float)stroke.brushSize, col);
+        mesh.Clear();
+        highlightMesh.Clear();
+        pendingRuns.clear();
+        clearPending = false;
+        strokeEnding = false;
+    }
 
-        EndTextureMode();
+    //--------------------------------------------------------------------------------------
+    // Edits
+    //--------------------------------------------------------------------------------------
+    void BeginEdit(bool erase) {
+        if (!history.Enabled()) return;
+        edits.resize(history.UndoSteps()); // drops the redo branch, as history does
+        history.BeginEdit();
+        edits.push_back({ erase, {}, {} });
+    }
+
+    void EndEdit() {
+        history.EndEdit();
+        // Steps the history ring has dropped can't be undone any more
+        while (edits.size() > history.UndoSteps() + history.RedoSteps())
+            edits.pop_front();
+    }
+
+    // Takes the edit's strokes off the list (undoing a stroke, redoing an erase)
+    void TakeOut(StrokeEdit& e) {
+        e.out.resize(e.positions.size());
+        for (size_t k = e.positions.size(); k-- > 0;) {
+            index.Remove(strokes[e.positions[k]]);
+            e.out[k] = std::move(strokes[e.positions[k]]);
+            strokes.erase(strokes.begin() + e.positions[k]);
+        }
+    }
+
+    // Puts them back (redoing a stroke, undoing an erase)
+    void PutBack(StrokeEdit& e) {
+        for (size_t k = 0; k < e.positions.size(); k++) {
+            index.Add(e.out[k]);
+            strokes.insert(strokes.begin() + e.positions[k], std::move(e.out[k]));
+        }
+        e.out.clear();
+    }
+
+    void Undo() {
+        if (!history.Undo()) return;
+        StrokeEdit& e = edits[history.UndoSteps()];
+        if (e.erase) PutBack(e);
+        else TakeOut(e);
+        documentDirty = true;
+    }
+
+    void Redo() {
+        if (!history.Redo()) return;
+        StrokeEdit& e = edits[history.UndoSteps() - 1];
+        if (e.erase) TakeOut(e);
+        else PutBack(e);
+        documentDirty = true;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Eraser
+    //--------------------------------------------------------------------------------------
+    // Marks the tiles under a stroke for redrawing (and for an undo copy). They are the
+    // history's tiles, so a redraw never reaches past what the undo copy holds.
+    void MarkStroke(const Stroke& stroke) {
+        float r = stroke.brushSize + StrokeIndex::CurveMargin + 1.0f;
+        float x0 = stroke.points[0].x, y0 = stroke.points[0].y, x1 = x0, y1 = y0;
+        for (const Vector2& p : stroke.points) {
+            x0 = std::min(x0, p.x); y0 = std::min(y0, p.y);
+            x1 = std::max(x1, p.x); y1 = std::max(y1, p.y);
+        }
+        x0 -= r; y0 -= r; x1 += r; y1 += r;
+        history.Touch(x0, y0, x1, y1);
+
+        const float ts = (float)CanvasHistory::TileSize;
+        int tx0 = (int)floorf(x0 / ts), tx1 = (int)floorf(x1 / ts);
+        int ty0 = (int)floorf(y0 / ts), ty1 = (int)floorf(y1 / ts);
+        for (int ty = ty0; ty <= ty1; ty++)
+            for (int tx = tx0; tx <= tx1; tx++)
+                if (dirtyTile.insert(TiledCanvas::Key(0, tx, ty)).second)
+                    dirtyTiles.push_back({ tx, ty });
+    }
+
+    // Removes every stroke the eraser touched moving from `from` to `to`
+    void EraseAlong(Vector2 from, Vector2 to) {
+        index.Hit(from, to, (float)brushSize, hits);
+        if (hits.empty()) return;
+
+        if (!erasing) {
+            erasing = true;
+            BeginEdit(true);
+        }
+        StrokeEdit* edit = history.Enabled() ? &edits.back() : nullptr;
+
+        // Positions in the list before this erase began: earlier removals shift them up
+        std::vector<std::pair<size_t, Stroke>> removed;
+        for (size_t i = 0; i < strokes.size(); i++) {
+            if (!std::binary_search(hits.begin(), hits.end(), strokes[i].id)) continue;
+            size_t original = i;
+            if (edit)
+                for (size_t p : edit->positions) original += (p <= original) ? 1 : 0;
+            removed.push_back({ original, {} });
+            MarkStroke(strokes[i]);
+            index.Remove(strokes[i]);
+            removed.back().second = std::move(strokes[i]);
+        }
+        strokes.erase(std::remove_if(strokes.begin(), strokes.end(),
+            [&](const Stroke& s) { return std::binary_search(hits.begin(), hits.end(), s.id); }), strokes.end());
+
+        if (edit) {
+            for (size_t k = 0; k < edit->positions.size(); k++)
+                removed.push_back({ edit->positions[k], std::move(edit->out[k]) });
+            std::sort(removed.begin(), removed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            edit->positions.clear();
+            edit->out.clear();
+            for (auto& r : removed) {
+                edit->positions.push_back(r.first);
+                edit->out.push_back(std::move(r.second));
+            }
+        }
+
+        history.SnapshotBefore();
+        RedrawDirtyTiles();
+        documentDirty = true;
+    }
+
+    // Clears each marked tile and draws the strokes that reach it, in list order so they
+    // overlap as before. The canvas scissors every stroke to the tile being redrawn.
+    void RedrawDirtyTiles() {
+        if (dirtyTiles.empty()) return;
+
+        const float ts = (float)CanvasHistory::TileSize;
+        hits.clear();
+        std::vector<uint32_t> found;
+        for (auto [tx, ty] : dirtyTiles) {
+            index.Query(tx * ts, ty * ts, (tx + 1) * ts, (ty + 1) * ts, found);
+            hits.insert(hits.end(), found.begin(), found.end());
+        }
+        std::sort(hits.begin(), hits.end());
+        hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+
+        mesh.Clear();
+        highlightMesh.Clear();
+        for (const Stroke& stroke : strokes)
+            if (std::binary_search(hits.begin(), hits.end(), stroke.id))
+                AddStroke(MeshFor(stroke), stroke, StrokeColor(stroke), smoothed);
+
+        for (auto [tx, ty] : dirtyTiles) {
+            Rectangle area = { tx * ts, ty * ts, ts, ts };
+            tiles.Redraw(0, area, mesh);
+            tiles.Redraw(1, area, highlightMesh);
+        }
+        dirtyTile.clear();
+        dirtyTiles.clear();
+        mesh.Clear();
+        highlightMesh.Clear();
+    }
+
+    // Draws the loaded document into the layers once the loader is done. Drawing input
+    // waits for this, so the loaded strokes are always the oldest ones.
+    bool FinishLoad() {
+        std::vector<Stroke> loaded;
+        if (!loader.Take(loaded, mesh, highlightMesh)) return false;
+
+        strokes = std::move(loaded);
+        for (Stroke& stroke : strokes) {
+            stroke.id = nextStrokeId++;
+            index.Add(stroke);
+        }
+        tiles.Draw(0, mesh);
+        tiles.Draw(1, highlightMesh);
+        mesh.Clear();
+        highlightMesh.Clear();
+
+        // Compacts the file and drops any damaged tail before strokes are appended to it.
+        // A file this version can't read is left alone and the session isn't saved.
+        saving = loader.Writable();
+        if (saving) writer.Rewrite(cfg.documentFile, strokes);
+        return true;
+    }
+
+    // A rewrite re-encodes every stroke, so it follows the edit rather than the frame: an
+    // erase drag is written once it ends, and held Ctrl+Z once the key is let go
+    void SaveDocument() {
+        if (erasing || IsKeyDown(KEY_Z)) return;
+        if (documentDirty && saving)
+            writer.Rewrite(cfg.documentFile, strokes);
+        documentDirty = false;
+    }
+
+    // The sampler thread polls at 1 kHz, so it only runs while drawing is on screen
+    void OnActivate() override {
+        if (canvasInitialized) sampler.Start();
+    }
+
+    void OnDeactivate() override {
+        sampler.Stop();
     }
 
     void Update() override {
         InitCanvas();
+        tiles.BeginFrame();
+        // Drained every frame, loading or not, so old samples never reach a stroke
+        sampler.Drain(samples);
+        if (loader.Busy() && !FinishLoad()) return;
 
         bool highlighter = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
         Color currentColor = CurrentColor();
@@ -127,31 +516,76 @@ public:
             }
         }
 
+        // Scroll zooms about the cursor, middle drag pans, Home goes back to the start
+        if (!IsKeyDown(KEY_LEFT_CONTROL) && !IsKeyDown(KEY_RIGHT_CONTROL)
+            && !IsKeyDown(KEY_LEFT_ALT) && !IsKeyDown(KEY_RIGHT_ALT)) {
+            float wheel = GetMouseWheelMove();
+            if (wheel != 0) ZoomAt(GetMousePosition(), powf(1.25f, wheel));
+        }
+        if (IsMouseButtonDown(MOUSE_MIDDLE_BUTTON)) {
+            Vector2 delta = GetMouseDelta();
+            camera.target.x -= delta.x / camera.zoom;
+            camera.target.y -= delta.y / camera.zoom;
+        }
+        if (IsKeyPressed(KEY_HOME)) camera = { { 0, 0 }, { 0, 0 }, 0.0f, 1.0f };
+
         if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
             if (!drawing) {
                 drawing = true;
-                strokes.push_back({ {}, currentColor, brushSize, highlighter });
+                strokes.push_back({ {}, currentColor, brushSize, highlighter, nextStrokeId++ });
+                BeginEdit(false);
+                if (history.Enabled()) edits.back().positions.push_back(strokes.size() - 1);
+
+                // Starts where the button went down, if the sampler saw it yet
+                Vector2 start = GetMousePosition();
+                size_t next = 0;
+                while (next < samples.size() && !samples[next].down) next++;
+                if (next < samples.size()) start = samples[next++].position;
+
+                // The tolerance is in screen pixels, so it shrinks in world terms when zoomed in
+                filter.Begin(strokes.back().points, ToWorld(start), cfg.simplifyTolerance / camera.zoom);
+                finalized = 0;
+                strokeSamples = 0;
+                QueuePoint(strokes.size() - 1, 0);
+                if (sampler.Running()) AddSamples(next);
             }
-
-            Vector2 mousePos = GetMousePosition();
-            strokes.back().points.push_back(mousePos);
-
-            DrawStrokeSegment(strokes.back(), strokes.back().points.size() - 1, canvas);
-        }
-        else {
-            if (drawing) {
-                drawing = false;
-                if (!strokes.empty()) {
-                    DrawStrokeEndCap(strokes.back(), canvas);
-                }
+            else {
+                AddSamples(0);
             }
         }
+        else if (drawing) {
+            // Samples from before the release
+            if (sampler.Running()) AddSamples(0);
+            if (strokeSamples > 1 && strokeEnd > strokeStart)
+                inputRate = (float)((strokeSamples - 1) / (strokeEnd - strokeStart));
+            filter.End(strokes.back().points);
+            QueueFinal(strokes.back().points.size() - 1);
+            sampledPoints += filter.RawSamples();
+            storedPoints += strokes.back().points.size();
+            writer.Append(strokes.back());
+            index.Add(strokes.back());
+            drawing = false;
+            strokeEnding = true;
+        }
 
         if ((IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && IsKeyPressed(KEY_C)) {
             strokes.clear();
-            BeginTextureMode(canvas);
-            ClearBackground({ 0,0,0,0 });
-            EndTextureMode();
+            edits.clear();
+            index.Clear();
+            erasing = false;
+            pendingRuns.clear();
+            history.Clear();
+            documentDirty = true;
+            strokeEnding = false;
+            drawing = false;
+            clearPending = true;
+        }
+
+        // Ctrl+Z undo, Ctrl+Shift+Z redo (Ctrl+Y is taken by the global topmost hotkey)
+        if ((IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && !drawing && !erasing
+            && (IsKeyPressed(KEY_Z) || IsKeyPressedRepeat(KEY_Z))) {
+            if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) Redo();
+            else Undo();
         }
 
         if (IsKeyPressed(KEY_UP) || IsKeyPressedRepeat(KEY_UP))
@@ -167,29 +601,59 @@ public:
 				if (brushSize > cfg.maxBrushSize) brushSize = cfg.maxBrushSize;
 			}
 		}
+
+        FlushCanvas();
+
+        // Right drag erases whole strokes. Runs after the flush so no queued run points
+        // at a stroke that is about to move.
+        if (IsMouseButtonDown(MOUSE_RIGHT_BUTTON) && !drawing) {
+            Vector2 mousePos = ToWorld(GetMousePosition());
+            EraseAlong(IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) ? mousePos : lastErase, mousePos);
+            lastErase = mousePos;
+        }
+        else if (erasing) {
+            EndEdit();
+            erasing = false;
+        }
+
+        tiles.Prepare(camera, width, height);
+        BuildTail();
+        SaveDocument();
     }
 
     void Draw() override {
         InitCanvas();
 
-        DrawTextureRec(
-            canvas.texture,
-            { 0, 0, (float)canvas.texture.width, -(float)canvas.texture.height },
-            { 0, 0 },
-            WHITE
-        );
+        // Tiles don't overlap, so fading each one fades the layer as a whole
+        if (tailInView) {
+            DrawTextureRec(
+                highlightView.texture,
+                { 0, 0, (float)width, -(float)height },
+                { 0, 0 },
+                Fade(WHITE, cfg.highlighterAlpha)
+            );
+        }
+        BeginMode2D(camera);
+        if (!tailInView) tiles.DrawView(1, camera, width, height, Fade(WHITE, cfg.highlighterAlpha));
+        tiles.DrawView(0, camera, width, height, WHITE);
+        tailMesh.Draw();
+        EndMode2D();
 
         if (!config->MousePassthrough) {
             Vector2 mousePos = GetMousePosition();
             bool highlighter = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+            float radius = brushSize * camera.zoom; // brush sizes are in world pixels
 
             // Brush preview
-            if (highlighter) {
-                DrawCircleV(mousePos, (float)brushSize, Fade(CurrentColor(), cfg.highlighterAlpha));
-                DrawCircleLinesV(mousePos, (float)brushSize, Fade(CurrentColor(), 0.6f));
+            if (IsMouseButtonDown(MOUSE_RIGHT_BUTTON)) {
+                DrawCircleLinesV(mousePos, radius, Fade(LIGHTGRAY, 0.8f));
+            }
+            else if (highlighter) {
+                DrawCircleV(mousePos, radius, Fade(CurrentColor(), cfg.highlighterAlpha));
+                DrawCircleLinesV(mousePos, radius, Fade(CurrentColor(), 0.6f));
             }
             else {
-                DrawCircleLinesV(mousePos, (float)brushSize, Fade(CurrentColor(), 0.6f));
+                DrawCircleLinesV(mousePos, radius, Fade(CurrentColor(), 0.6f));
             }
 
 			if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL))
@@ -204,7 +668,7 @@ public:
                     float radius = 10;
 
                     float spacing = radius * 2.5f;
-                    Vector2 basePos = { (float)mousePos.x, (float)mousePos.y - ((radius * 1.5f) + brushSize + 2.0f) };
+                    Vector2 basePos = { (float)mousePos.x, (float)mousePos.y - ((radius * 1.5f) + brushSize * camera.zoom + 2.0f) };
 
                     // Previous (left)
                     DrawCircleV({ basePos.x - spacing, basePos.y }, radius, cfg.presetColors[prevIdx]);
@@ -227,13 +691,22 @@ public:
     void DrawUIOverlay() override {
         if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)
             || IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)) {
-            DrawRectangle(10, 10, 320, 120, Color{ 0,0,0,150 });
+            DrawRectangle(10, 10, 320, 240, Color{ 0,0,0,150 });
             DrawText(TextFormat("Strokes: %d", (int)strokes.size()), 20, 20, 10, LIGHTGRAY);
             DrawText(TextFormat("Current Brush Size: %d", brushSize), 20, 35, 10, YELLOW);
             DrawText(TextFormat("Highlighter Alpha: %.2f", cfg.highlighterAlpha), 20, 50, 10, LIGHTGRAY);
             DrawText("Ctrl+Scroll to change color", 20, 65, 10, LIGHTGRAY);
             DrawText("Hold Shift for highlighter mode", 20, 80, 10, LIGHTGRAY);
-            DrawText(std::string("FPS: " + std::to_string(GetFPS())).c_str(), 20, 95, 10, GREEN);
+            DrawText("Right drag to erase strokes", 20, 95, 10, LIGHTGRAY);
+            DrawText("Ctrl+Z undo, Ctrl+Shift+Z redo", 20, 110, 10, LIGHTGRAY);
+            DrawText(TextFormat("History: %d undo / %d redo, %d/%d tiles", (int)history.UndoSteps(), (int)history.RedoSteps(),
+                (int)history.SlotsUsed(), history.Slots()), 20, 125, 10, LIGHTGRAY);
+            DrawText(TextFormat("Points: %d stored of %d sampled", (int)storedPoints, (int)sampledPoints), 20, 140, 10, LIGHTGRAY);
+            DrawText(TextFormat("Input: %d samples/s last stroke, %d dropped", (int)inputRate, (int)sampler.Dropped()), 20, 155, 10, LIGHTGRAY);
+            DrawText("Scroll to zoom, middle drag to pan, Home to reset", 20, 170, 10, LIGHTGRAY);
+            DrawText(TextFormat("View: %.0f%% zoom, mip level %d", camera.zoom * 100.0f, TiledCanvas::Level(camera.zoom)), 20, 185, 10, LIGHTGRAY);
+            DrawText(TextFormat("Tiles: %d in memory, %d on disk", (int)tiles.Resident(), (int)tiles.Spilled()), 20, 200, 10, LIGHTGRAY);
+            DrawText(std::string("FPS: " + std::to_string(GetFPS())).c_str(), 20, 215, 10, GREEN);
         }
     }
 };
\ No newline at end of file
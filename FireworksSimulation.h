@@ -3,169 +3,116 @@
 #include "Config.h"
 #include "Helper.h"
 #include "Simulation.h"
+#include "SparkPool.h"
+#include "SparkKernels.h"
+#include "ShellTypes.h"
+#include "GlowBuffer.h"
+#include "ShowTimeline.h"
+#include "JobPool.h"
 #include <vector>
+#include <memory>
 #include <random>
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
 
 extern ConfigManager configManager;
 extern std::mt19937 gen;
 extern std::uniform_real_distribution<float> dist01;
 
-// ======================================================
-// Spark
-// ======================================================
-struct Spark {
-    float x, y;
-    float vx, vy;
-    float life;
-    float r, g, b;
-
-    static constexpr int TRAIL_MAX = 10; // shorter trail for performance
-    Vector2 trail[TRAIL_MAX];
-    int trailCount = 0;
-    int trailHead = 0;
-
-    Spark(float sx, float sy) {
-        x = sx; y = sy;
-        float angle = dist01(gen) * 2.0f * PI;
-        float speed = dist01(gen) * 4.0f + 1.0f;
-        vx = cosf(angle) * speed;
-        vy = sinf(angle) * speed;
-        life = dist01(gen) * 1.0f + 1.0f;
-        r = dist01(gen);
-        g = dist01(gen);
-        b = dist01(gen);
-
-        // Initialize trail properly
-        for (int i = 0; i < TRAIL_MAX; i++) {
-            trail[i] = { x, y };
-        }
-        trailCount = 1;
-        trailHead = 0;
-    }
-
-    void AddTrail() {
-        trail[trailHead] = { x, y };
-        trailHead = (trailHead + 1) % TRAIL_MAX;
-        if (trailCount < TRAIL_MAX) trailCount++;
-    }
-
-    bool Update(float dt) {
-        AddTrail();
-
-        vy += 1.5f * dt; // gravity
-        x += vx;
-        y += vy;
-        life -= dt;
-
-        return life > 0.0f;
-    }
-
-    void Draw() const {
-        // Only draw if we have at least 2 valid trail points
-        if (trailCount > 1) {
-            int idx = trailHead;
-            for (int i = 1; i < trailCount; i++) {
-                int prev = (idx + TRAIL_MAX - 1) % TRAIL_MAX;
-                float alpha = (float)i / trailCount;
-                Color tc = {
-                    (unsigned char)(r * 255),
-                    (unsigned char)(g * 255),
-                    (unsigned char)(b * 255),
-                    (unsigned char)(alpha * 180)
-                };
-                DrawLineV(trail[prev], trail[idx], tc);
-                idx = (idx + 1) % TRAIL_MAX;
-            }
-        }
-
-        // Core spark
-        Color c = { 255, 255, 255, (unsigned char)(Clamp(life * 255, 0.0f, 255.0f)) };
-        DrawCircle((int)x, (int)y, 2, c);
-    }
-};
-
 // ======================================================
 // Firework
 // ======================================================
+// A rocket is only its launch parameters: its position is the closed-form ballistic
+// path evaluated at its age, so it reaches the target at exactly flightTime whatever
+// the frame rate, and updating one is a single add.
 struct Firework {
-    float x, y;
-    float tx, ty;
-    float vx, vy;
-    bool exploded = false;
+    static constexpr float PopTime = 0.2f;
+
+    float x0, y0;          // launch point
+    float vx, vy;          // launch velocity, pixels per second
+    float gravity;         // pixels per second squared
+    float flightTime;      // seconds until the target is reached
+    float age = 0.0f;
     bool popping = false;
     float popTimer = 0.0f;
+    int shell = -1; // index into the shell templates, -1 = plain random burst
 
-    std::vector<Spark> sparks; // sparks owned by this firework
+    Firework(int startX, int startY, int targetX, int targetY, float flightTime, float gravity, int shellType = -1)
+        : gravity(gravity), flightTime(std::max(flightTime, 0.01f)), shell(shellType) {
+        x0 = (float)startX; y0 = (float)startY;
 
-    Firework(int startX, int startY, int targetX, int targetY) {
-        x = (float)startX; y = (float)startY;
-        tx = (float)targetX; ty = (float)targetY;
+        // Solve x(T) = tx, y(T) = ty for the launch velocity
+        float t = this->flightTime;
+        vx = (targetX - x0) / t;
+        vy = (targetY - y0 - 0.5f * gravity * t * t) / t;
+    }
 
-        float dx = tx - x, dy = ty - y;
-        float t = 60.0f; // "time" to reach target
-        vx = dx / t;
-        float g = 0.15f;
-        vy = (dy - 0.5f * g * t * t) / t;
+    Vector2 Position() const {
+        float t = std::min(age, flightTime);
+        return { x0 + vx * t, y0 + vy * t + 0.5f * gravity * t * t };
     }
 
+    // Returns true once the pop is over and the shell should burst
     bool Update(float dt) {
-        if (!exploded && !popping) {
-            vy += 0.15f;
-            x += vx; y += vy;
-
-            if ((vx >= 0 && x >= tx) || (vx <= 0 && x <= tx)) {
-                if ((vy >= 0 && y >= ty) || (vy <= 0 && y <= ty)) {
-                    popping = true;
-                    popTimer = 0.2f;
-                }
+        if (!popping) {
+            age += dt;
+            if (age >= flightTime) {
+                // Time past the target this frame already counts toward the pop
+                popping = true;
+                popTimer = PopTime - (age - flightTime);
             }
         }
-        else if (popping) {
-            popTimer -= dt;
-            if (popTimer <= 0.0f) DoExplode();
-        }
         else {
-            for (size_t i = 0; i < sparks.size();) {
-                if (!sparks[i].Update(dt)) {
-                    sparks[i] = sparks.back();
-                    sparks.pop_back();
-                }
-                else {
-                    ++i;
-                }
-            }
-            if (sparks.empty()) return true; // finished
+            popTimer -= dt;
         }
-        return false;
+
+        return popping && popTimer <= 0.0f;
+    }
+
+    const ShellTemplate* Template(const std::vector<ShellTemplate>& shells) const {
+        return (shell >= 0 && shell < (int)shells.size()) ? &shells[shell] : nullptr;
+    }
+
+    // Sparks this shell bursts into; plain random bursts pick their size here
+    size_t BurstSize(const std::vector<ShellTemplate>& shells) const {
+        if (const ShellTemplate* t = Template(shells)) return t->Size();
+        return (size_t)(dist01(gen) * 25 + 25); // 25-50 sparks
+    }
+
+    // Fills the n pool slots claimed for this shell's burst from `first`
+    void Burst(SparkPool& pool, const std::vector<ShellTemplate>& shells, size_t first, size_t n, std::mt19937& rng) const {
+        Vector2 p = Position();
+        if (const ShellTemplate* t = Template(shells))
+            FillShell(pool, *t, first, n, p.x, p.y, rng);
+        else
+            pool.FillRandom(first, n, p.x, p.y, rng);
     }
 
     void Draw() const {
-        if (!exploded && !popping) {
-            DrawCircle((int)x, (int)y, 2, YELLOW);
+        Vector2 p = Position();
+        if (!popping) {
+            DrawCircle((int)p.x, (int)p.y, 2, YELLOW);
         }
-        else if (popping) {
-            float progress = 1.0f - (popTimer / 0.2f);
+        else {
+            // White-hot core; the halo around it comes from the glow buffer
+            float progress = 1.0f - (popTimer / PopTime);
             float radius = 30.0f * progress;
 
             Color c1 = { 255,255,255,(unsigned char)(255 * (1.0f - progress)) };
-            Color c2 = { 255,255,0,(unsigned char)(200 * (1.0f - progress)) };
-            Color c3 = { 255,200,50,(unsigned char)(120 * (1.0f - progress)) };
-            DrawCircle((int)x, (int)y, radius * 0.4f, c1);
-            DrawCircle((int)x, (int)y, radius * 0.7f, c2);
-            DrawCircle((int)x, (int)y, radius, c3);
-        }
-        else {
-            for (auto const& s : sparks) s.Draw();
+            DrawCircle((int)p.x, (int)p.y, radius * 0.4f, c1);
         }
     }
 
-private:
-    void DoExplode() {
-        popping = false; exploded = true;
-        int count = (int)(dist01(gen) * 25 + 25); // 2550 sparks
-        sparks.reserve(count);
-        for (int i = 0; i < count; i++) sparks.emplace_back(x, y);
+    void Light(GlowBuffer& glow) const {
+        Vector2 p = Position();
+        if (!popping) {
+            glow.Splat(p.x, p.y, YELLOW, 0.5f);
+        }
+        else {
+            float progress = 1.0f - (popTimer / PopTime);
+            glow.Splat(p.x, p.y, { 255, 200, 50, 255 }, 12.0f * (1.0f - progress));
+        }
     }
 };
 
@@ -174,17 +121,30 @@ private:
 // ======================================================
 class Spawner {
 public:
-    void TrySpawn(std::vector<Firework>& fireworks, int width, int height) {
+    void TrySpawn(std::vector<Firework>& fireworks, int width, int height, int shellTypes,
+        const FireworksSimulationConfig& config, float dt) {
         if (IsMouseButtonPressedGlobal(MOUSE_LEFT_BUTTON)) {
-            Vector2 mouse = GetCursorPosition();
-            fireworks.emplace_back(width / 2, height, (int)mouse.x, (int)mouse.y);
+            Launch(fireworks, width, height, shellTypes, config);
             return;
         }
-        if (dist01(gen) < 0.01f) {
-            Vector2 mouse = GetCursorPosition();
-            fireworks.emplace_back(width / 2, height, (int)mouse.x, (int)mouse.y);
+        // Poisson launches: the same rate per second at any frame rate
+        if (dist01(gen) < 1.0f - expf(-config.LaunchRate * dt)) {
+            Launch(fireworks, width, height, shellTypes, config);
         }
     }
+
+private:
+    static void Launch(std::vector<Firework>& fireworks, int width, int height, int shellTypes,
+        const FireworksSimulationConfig& config) {
+        Vector2 mouse = GetCursorPosition();
+        fireworks.emplace_back(width / 2, height, (int)mouse.x, (int)mouse.y,
+            config.RocketFlightTime, config.RocketGravity, PickShell(shellTypes));
+    }
+
+    static int PickShell(int shellTypes) {
+        if (shellTypes <= 0) return -1;
+        return std::min((int)(dist01(gen) * shellTypes), shellTypes - 1);
+    }
 };
 
 // ======================================================
@@ -197,28 +157,232 @@ public:
         height = GetScreenHeight();
         WindowTitle = "Fireworks Simulation - F2: Toggle Click-Through, Ctrl+Y: Toggle Topmost";
         SetWindowTitle(WindowTitle.c_str());
+
+        config = configManager.GetConfig()->FireworksSimConfig;
+        shells = BuildShellTemplates(config.ShellTypes);
+
+        // A show replaces the random launches and sizes the pools for its busiest moment
+        // up front, so nothing grows while it plays
+        size_t sparkCapacity = (size_t)std::max(config.MaxSparks, 1);
+        if (!config.ShowFile.empty() && show.Load(config.ShowFile, config, config.RocketFlightTime + Firework::PopTime, config.ShowLoop)) {
+            config.LaunchRate = 0.0f;
+            sparkCapacity = std::max(sparkCapacity, show.PeakSparks());
+            fireworks.reserve(show.PeakRockets() + 16);
+        }
+        sparks.Reserve(sparkCapacity);
+
+        sparks.lod.sparkThreshold = (size_t)std::max(config.LodSparkThreshold, 1);
+        sparks.lod.reducedLife = config.LodReducedLife;
+        sparks.lod.minimalLife = config.LodMinimalLife;
+        sparks.lod.cullLife = config.LodCullLife;
+
+        ground.SetFloor(FloorY());
+        ground.bounce = config.GroundBounce;
+        ground.friction = config.GroundFriction;
+
+        jobs = std::make_unique<JobPool>(config.WorkerThreads < 0 ? JobPool::DefaultWorkers() : (unsigned)config.WorkerThreads);
+        scratch.resize(jobs->Slots());
+        for (auto& w : scratch) {
+            w.rng.seed(gen());
+            w.bursts.reserve(256);
+        }
+
+        if (config.GlowScale > 0.0f) {
+            glow.Resize(width, height, std::min(config.GlowScale, 1.0f));
+            glow.Load();
+        }
+
+        // Room for a full trail (as lines) plus a core quad per spark, in 4-vertex elements
+        batch = rlLoadRenderBatch(1, (int)std::min(sparks.Capacity() * 6, (size_t)98304));
+    }
+
+    ~FireworksSimulation() {
+        rlUnloadRenderBatch(batch);
+        glow.Unload();
     }
 
     void Update() override {
         float dt = GetFrameTime();
-        spawner.TrySpawn(fireworks, width, height);
+        spawner.TrySpawn(fireworks, width, height, (int)shells.size(), config, dt);
+        show.Update(dt, config.ShowLoop, [&](const ShowEvent& e) {
+            fireworks.emplace_back((int)(e.launchX * width), (int)(e.launchY * height),
+                (int)(e.targetX * width), (int)(e.targetY * height),
+                config.RocketFlightTime, config.RocketGravity, e.shell);
+        });
 
-        for (size_t i = 0; i < fireworks.size();) {
-            if (fireworks[i].Update(dt))
-                fireworks[i] = fireworks.back(), fireworks.pop_back();
-            else
-                ++i;
-        }
+        ground.SetFloor(FloorY());
+        UpdateRockets(dt);
+
+        sparks.BurnFuses(dt);
+        sparks.UpdateLod();
+        bool pushTrail = sparks.TrailDue(dt);
+        size_t firstDead = UpdateSparks(dt, pushTrail);
+        if (pushTrail) sparks.AdvanceTrail();
+        if (firstDead < sparks.count) sparks.Retire(firstDead);
+
+        if (config.GlowScale > 0.0f) UpdateGlow();
     }
 
     void Draw() override {
+        glow.Upload();
+        glow.Draw(width, height);
+
+        // The whole spark layer goes through our own batch: one draw for trails, one for cores
+        rlSetRenderBatchActive(&batch);
+        sparks.Draw();
+        rlSetRenderBatchActive(NULL);
+
         for (auto& fw : fireworks)
             fw.Draw();
     }
 
-    void DrawUIOverlay() override {}
+    void DrawUIOverlay() override {
+        if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)
+            || IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)) {
+            DrawRectangle(10, 10, 280, 120, Color{ 0, 0, 0, 150 });
+            DrawText(TextFormat("Sparks: %d / %d", (int)sparks.count, (int)sparks.Capacity()), 20, 20, 10, LIGHTGRAY);
+            DrawText(TextFormat("Rockets: %d", (int)fireworks.size()), 20, 35, 10, LIGHTGRAY);
+            DrawText(TextFormat("Drawn full: %d, half trail: %d, core: %d",
+                (int)lodCounts[SparkPool::LodFull], (int)lodCounts[SparkPool::LodReduced], (int)lodCounts[SparkPool::LodMinimal]), 20, 50, 10, LIGHTGRAY);
+            DrawText(TextFormat("Trail/cull stretch: x%.2f, culled: %d", sparks.lodScale, (int)culled), 20, 65, 10, YELLOW);
+            DrawText(TextFormat("Threshold: %d sparks", config.LodSparkThreshold), 20, 80, 10, YELLOW);
+            DrawText(std::string("FPS: " + std::to_string(GetFPS())).c_str(), 20, 95, 10, GREEN);
+        }
+    }
+
+    FireworksSimulationConfig config;
 
 private:
+    // Top of the taskbar when TaskbarAware, otherwise the bottom row of the screen
+    float FloorY() {
+        int floorY = height;
+        if (configManager.GetConfig()->TaskbarAware)
+            floorY -= configManager.GetTaskbarHeight();
+        else floorY -= 1;
+        return (float)floorY;
+    }
+
+    static constexpr size_t RocketGrain = 64;
+    static constexpr size_t BurstGrain = 8;
+    static constexpr size_t SparkGrain = 4096; // multiple of 8 so every chunk but the last stays on the AVX2 path
+
+    // Per job slot state, padded so slots never share a cache line
+    struct alignas(64) WorkerScratch {
+        std::vector<size_t> bursts;   // rockets that burst this frame
+        size_t firstDead = 0;         // lowest dead spark index seen this frame
+        size_t tiers[SparkPool::LodTierCount] = {};
+        size_t culled = 0;
+        std::mt19937 rng;
+    };
+
+    struct PendingBurst {
+        size_t rocket;
+        size_t first, count;
+    };
+
+    // Rockets advance in parallel and each worker lists the ones that burst. The lists
+    // are merged here, claiming pool slots for every burst in one go, then the bursts
+    // are filled in parallel, each worker drawing from its own RNG stream.
+    void UpdateRockets(float dt) {
+        for (auto& w : scratch) w.bursts.clear();
+        auto advance = [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t i = begin; i < end; i++)
+                if (fireworks[i].Update(dt)) scratch[slot].bursts.push_back(i);
+        };
+        jobs->ParallelFor(fireworks.size(), RocketGrain, advance);
+
+        bursts.clear();
+        for (auto& w : scratch) {
+            for (size_t rocket : w.bursts) {
+                PendingBurst b = { rocket, 0, 0 };
+                b.count = sparks.Allocate(fireworks[rocket].BurstSize(shells), b.first);
+                const ShellTemplate* t = fireworks[rocket].Template(shells);
+                if (t && t->splitTime > 0.0f) sparks.pendingSplits += b.count;
+                bursts.push_back(b);
+            }
+        }
+        if (bursts.empty()) return;
+
+        auto fill = [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t k = begin; k < end; k++)
+                fireworks[bursts[k].rocket].Burst(sparks, shells, bursts[k].first, bursts[k].count, scratch[slot].rng);
+        };
+        jobs->ParallelFor(bursts.size(), BurstGrain, fill);
+
+        // Swap-and-pop from the highest index down so the remaining indices stay valid
+        std::sort(bursts.begin(), bursts.end(),
+            [](const PendingBurst& a, const PendingBurst& b) { return a.rocket > b.rocket; });
+        for (const auto& b : bursts) {
+            fireworks[b.rocket] = fireworks.back();
+            fireworks.pop_back();
+        }
+    }
+
+    // Spark ranges integrate in parallel. The same pass culls sparks too faint to see,
+    // counts LOD tiers for the HUD and notes the first dead spark, so retirement can
+    // start there, or be skipped when nothing died.
+    size_t UpdateSparks(float dt, bool pushTrail) {
+        for (auto& w : scratch) {
+            w.firstDead = SIZE_MAX;
+            std::fill(std::begin(w.tiers), std::end(w.tiers), 0);
+            w.culled = 0;
+        }
+        const float cullLife = sparks.CullLife();
+
+        auto step = [&](size_t begin, size_t end, unsigned slot) {
+            IntegrateSparks(sparks, dt, begin, end, pushTrail);
+            if (config.GroundCollision) CollideSparks(sparks, ground, begin, end);
+
+            WorkerScratch& w = scratch[slot];
+            for (size_t i = begin; i < end; i++) {
+                float life = sparks.life[i];
+                if (life <= cullLife) {
+                    if (life > 0.0f) {
+                        sparks.life[i] = 0.0f;
+                        w.culled++;
+                    }
+                    w.firstDead = std::min(w.firstDead, i);
+                    continue;
+                }
+                w.tiers[sparks.Tier(life)]++;
+            }
+        };
+        jobs->ParallelFor(sparks.count, SparkGrain, step);
+
+        size_t firstDead = sparks.count;
+        std::fill(std::begin(lodCounts), std::end(lodCounts), 0);
+        culled = 0;
+        for (auto& w : scratch) {
+            firstDead = std::min(firstDead, w.firstDead);
+            for (int t = 0; t < SparkPool::LodTierCount; t++) lodCounts[t] += w.tiers[t];
+            culled += w.culled;
+        }
+        return firstDead;
+    }
+
+    // Every spark and rocket splats into the light buffer, which is blurred and resolved
+    // once; the spark count only affects the splat loop.
+    void UpdateGlow() {
+        glow.Clear();
+        for (size_t i = 0; i < sparks.count; i++)
+            glow.Splat(sparks.x[i], sparks.y[i], sparks.color[i], config.GlowIntensity * Clamp(sparks.life[i], 0.0f, 1.0f));
+        for (auto& fw : fireworks)
+            fw.Light(glow);
+        glow.Blur(config.GlowRadius, config.GlowPasses);
+        glow.Resolve();
+    }
+
     std::vector<Firework> fireworks;
+    SparkPool sparks;
+    std::vector<ShellTemplate> shells;
+    GlowBuffer glow;
+    ShowTimeline show;
+    SparkGround ground;
+    std::unique_ptr<JobPool> jobs;
+    std::vector<WorkerScratch> scratch;
+    std::vector<PendingBurst> bursts;
+    size_t lodCounts[SparkPool::LodTierCount] = {};
+    size_t culled = 0;            // sparks culled early last update
+    rlRenderBatch batch = {};
     Spawner spawner;
 };
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+#include "raylib_win32.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+//--------------------------------------------------------------------------------------
+// Pre-rendered snowflake sprites plus a dedicated render batch.
+//
+// Every flake size is rasterized once (anti-aliased disc) into a one-row atlas, and
+// each flake becomes a textured quad whose vertex colour carries its alpha. The batch
+// is sized so that a screen full of flakes goes out in one or two draw calls instead of
+// being split every 8192 quads by raylib's default batch. Only plain textured quads are
+// used, so it renders the same on Mesa's software GL.
+//--------------------------------------------------------------------------------------
+class FlakeAtlas {
+public:
+    static constexpr int BatchQuads = 65536;
+
+    void Load(int minFlakeSize, int maxFlakeSize) {
+        minSize = std::max(1, minFlakeSize);
+        maxSize = std::max(minSize, maxFlakeSize);
+
+        // One cell per size, 1px gutter so neighbours never bleed
+        int atlasWidth = 0;
+        for (int s = minSize; s <= maxSize; s++) atlasWidth += s + 1;
+        int atlasHeight = maxSize;
+
+        Image image = GenImageColor(atlasWidth, atlasHeight, BLANK);
+        Color* pixels = (Color*)image.data;
+
+        cells.clear();
+        int cellX = 0;
+        for (int s = minSize; s <= maxSize; s++) {
+            float r = s * 0.5f;
+            for (int py = 0; py < s; py++) {
+                for (int px = 0; px < s; px++) {
+                    // Same footprint as DrawCircle(x, y, size / 2) centred on the cell
+                    float dx = px + 0.5f - r;
+                    float dy = py + 0.5f - r;
+                    float coverage = (s <= 1) ? 1.0f : std::clamp(r + 0.5f - sqrtf(dx * dx + dy * dy), 0.0f, 1.0f);
+                    pixels[py * atlasWidth + cellX + px] = { 255, 255, 255, (unsigned char)(coverage * 255) };
+                }
+            }
+            cells.push_back({ (float)cellX / atlasWidth, 0.0f, (float)(cellX + s) / atlasWidth, (float)s / atlasHeight });
+            cellX += s + 1;
+        }
+
+        texture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+
+        batch = rlLoadRenderBatch(1, BatchQuads);
+        loaded = true;
+    }
+
+    void Unload() {
+        if (!loaded) return;
+        rlUnloadRenderBatch(batch);
+        UnloadTexture(texture);
+        loaded = false;
+    }
+
+    void Begin() {
+        rlSetRenderBatchActive(&batch); // flushes whatever raylib had queued
+        rlSetTexture(texture.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+    }
+
+    // Quad for one flake centred on (x, y); single-pixel flakes cover the pixel like DrawPixel
+    void Add(float x, float y, int size, Color color) {
+        int s = std::clamp(size, minSize, maxSize);
+        const Rectangle& uv = cells[s - minSize];
+
+        float left = (s <= 1) ? x : x - s * 0.5f;
+        float top = (s <= 1) ? y : y - s * 0.5f;
+
+        rlColor4ub(color.r, color.g, color.b, color.a);
+        rlTexCoord2f(uv.x, uv.y);           rlVertex2f(left, top);
+        rlTexCoord2f(uv.x, uv.height);      rlVertex2f(left, top + s);
+        rlTexCoord2f(uv.width, uv.height);  rlVertex2f(left + s, top + s);
+        rlTexCoord2f(uv.width, uv.y);       rlVertex2f(left + s, top);
+    }
+
+    void End() {
+        rlEnd();
+        rlSetTexture(0);
+        rlSetRenderBatchActive(NULL); // draws our batch, back to raylib's default
+    }
+
+private:
+    Texture2D texture = {};
+    rlRenderBatch batch = {};
+    std::vector<Rectangle> cells; // uv rect per size: x0, y0, x1, y1
+    int minSize = 1;
+    int maxSize = 1;
+    bool loaded = false;
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include "GlowBuffer.h"
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <random>
+
+// ======================================================
+// Glow buffer check and benchmark (--bench-glow)
+// ======================================================
+// Runs the CPU glow path without a window. First checks that blurring a single light
+// keeps its energy, then times a full frame (clear, splat, blur, resolve) with few and
+// many lights to show that the cost is set by the buffer size and not by spark count.
+
+namespace GlowBenchmark {
+    constexpr int ScreenWidth = 1920;
+    constexpr int ScreenHeight = 1080;
+    constexpr int Frames = 100;
+    constexpr int Radius = 2;
+    constexpr int Passes = 2;
+
+    inline double MeasureFrame(GlowBuffer& glow, int lights) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> ux(0.0f, (float)ScreenWidth);
+        std::uniform_real_distribution<float> uy(0.0f, (float)ScreenHeight);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < Frames; f++) {
+            glow.Clear();
+            for (int i = 0; i < lights; i++)
+                glow.Splat(ux(rng), uy(rng), ORANGE, 0.6f);
+            glow.Blur(Radius, Passes);
+            glow.Resolve();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / Frames;
+    }
+}
+
+inline int RunGlowBenchmark() {
+    using namespace GlowBenchmark;
+    int failures = 0;
+
+    for (float scale : { 0.5f, 0.25f }) {
+        GlowBuffer glow;
+        glow.Resize(ScreenWidth, ScreenHeight, scale);
+
+        // A light in the middle is only spread out by the blur, never lost
+        glow.Clear();
+        glow.Splat(ScreenWidth * 0.5f, ScreenHeight * 0.5f, WHITE, 1.0f);
+        double before = glow.Total();
+        glow.Blur(Radius, Passes);
+        double after = glow.Total();
+        bool conserved = fabs(after - before) < 1e-3 * before;
+        if (!conserved) failures++;
+
+        printf("Glow buffer %dx%d (scale %.2f)\n", glow.Width(), glow.Height(), scale);
+        printf("  energy  : %.6f -> %.6f %s\n", before, after, conserved ? "ok" : "MISMATCH");
+        for (int lights : { 1024, 16384 })
+            printf("  %5d lights : %6.2f ms/frame\n", lights, MeasureFrame(glow, lights));
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include "raylib_win32.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+//--------------------------------------------------------------------------------------
+// Additive light buffer at a fraction of screen resolution.
+//
+// Bright things splat their light into three float planes (bilinear, so sub-texel
+// motion stays smooth), the planes get a few separable box blur passes built on
+// running sums, and the result is tonemapped into one small texture that is stretched
+// over the screen with additive blending. Splatting is a handful of adds per light.
+// Blur, resolve and upload cost depends only on the buffer size, so the glow costs the
+// same whether ten sparks or ten thousand are lit.
+//
+// Everything up to Resolve() is plain CPU code with no GL calls, so it also runs
+// headless (see GlowBenchmark.h). Only Upload()/Draw() touch the GPU.
+//--------------------------------------------------------------------------------------
+class GlowBuffer {
+public:
+    void Resize(int screenWidth, int screenHeight, float scale) {
+        this->scale = scale;
+        width = std::max(1, (int)(screenWidth * scale));
+        height = std::max(1, (int)(screenHeight * scale));
+
+        size_t texels = (size_t)width * height;
+        light.assign(texels * 3, 0.0f);
+        scratch.assign(texels * 3, 0.0f);
+        rowSum.assign(width, 0.0f);
+        zeroRow.assign(width, 0.0f);
+        pixels.assign(texels, BLANK);
+        lit = false;
+    }
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+    void Clear() {
+        if (lit) std::fill(light.begin(), light.end(), 0.0f);
+        lit = false;
+    }
+
+    // Adds `intensity` worth of light in colour c at screen position (x, y)
+    void Splat(float x, float y, Color c, float intensity) {
+        float fx = x * scale - 0.5f;
+        float fy = y * scale - 0.5f;
+        int ix = (int)floorf(fx), iy = (int)floorf(fy);
+        if (ix < -1 || iy < -1 || ix >= width || iy >= height) return;
+
+        float wx = fx - ix, wy = fy - iy;
+        float r = c.r / 255.0f * intensity;
+        float g = c.g / 255.0f * intensity;
+        float b = c.b / 255.0f * intensity;
+
+        const size_t plane = (size_t)width * height;
+        auto add = [&](int px, int py, float w) {
+            if (px < 0 || py < 0 || px >= width || py >= height) return;
+            size_t i = (size_t)py * width + px;
+            light[i] += r * w;
+            light[plane + i] += g * w;
+            light[2 * plane + i] += b * w;
+        };
+        add(ix, iy, (1 - wx) * (1 - wy));
+        add(ix + 1, iy, wx * (1 - wy));
+        add(ix, iy + 1, (1 - wx) * wy);
+        add(ix + 1, iy + 1, wx * wy);
+        lit = true;
+    }
+
+    // `passes` rounds of a (2 * radius + 1) box blur; three passes is close to a gaussian.
+    // Light past the edges is dropped rather than clamped so nothing piles up there.
+    void Blur(int radius, int passes) {
+        if (!lit || radius <= 0) return;
+
+        const size_t plane = (size_t)width * height;
+        const float inv = 1.0f / (2 * radius + 1);
+
+        for (int pass = 0; pass < passes; pass++) {
+            for (int c = 0; c < 3; c++) {
+                float* src = light.data() + c * plane;
+                float* tmp = scratch.data() + c * plane;
+
+                // Horizontal: one running sum per row
+                for (int y = 0; y < height; y++)
+                    BoxRow(src + (size_t)y * width, tmp + (size_t)y * width, radius, inv);
+
+                // Vertical: a running sum of whole rows, so every access is sequential
+                float* sum = rowSum.data();
+                std::fill(rowSum.begin(), rowSum.end(), 0.0f);
+                for (int y = 0; y < radius && y < height; y++) {
+                    const float* row = tmp + (size_t)y * width;
+                    for (int x = 0; x < width; x++) sum[x] += row[x];
+                }
+                for (int y = 0; y < height; y++) {
+                    const float* enter = (y + radius < height) ? tmp + (size_t)(y + radius) * width : zeroRow.data();
+                    const float* leave = (y - radius - 1 >= 0) ? tmp + (size_t)(y - radius - 1) * width : zeroRow.data();
+                    float* out = src + (size_t)y * width;
+                    for (int x = 0; x < width; x++) {
+                        sum[x] += enter[x] - leave[x];
+                        out[x] = sum[x] * inv;
+                    }
+                }
+            }
+        }
+    }
+
+    // Tonemaps the light into RGBA pixels. Alpha carries the brightness and colour is
+    // stored at full strength, so an additive draw adds exactly the tonemapped light.
+    void Resolve() {
+        if (!lit) {
+            if (resolved) std::fill(pixels.begin(), pixels.end(), BLANK);
+            resolved = false;
+            return;
+        }
+
+        const size_t plane = (size_t)width * height;
+        for (size_t i = 0; i < plane; i++) {
+            float r = light[i], g = light[plane + i], b = light[2 * plane + i];
+            r = r / (1.0f + r); g = g / (1.0f + g); b = b / (1.0f + b);
+
+            float m = std::max(r, std::max(g, b));
+            if (m < 1.0f / 255.0f) { pixels[i] = BLANK; continue; }
+
+            float k = 255.0f / m;
+            pixels[i] = { (unsigned char)(r * k), (unsigned char)(g * k), (unsigned char)(b * k), (unsigned char)(m * 255.0f) };
+        }
+        resolved = true;
+    }
+
+    // Sum of all light in the buffer (for checks)
+    double Total() const {
+        double total = 0.0;
+        for (float v : light) total += v;
+        return total;
+    }
+
+    const std::vector<Color>& Pixels() const { return pixels; }
+
+    //--------------------------------------------------------------------------------------
+    // GPU side
+    //--------------------------------------------------------------------------------------
+    void Load() {
+        Image image = GenImageColor(width, height, BLANK);
+        texture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+        loaded = true;
+    }
+
+    void Unload() {
+        if (!loaded) return;
+        UnloadTexture(texture);
+        loaded = false;
+    }
+
+    void Upload() {
+        if (!loaded || (!resolved && !uploaded)) return;
+        UpdateTexture(texture, pixels.data());
+        uploaded = resolved;
+    }
+
+    // One additive quad over the whole screen
+    void Draw(int screenWidth, int screenHeight) const {
+        if (!loaded || !uploaded) return;
+        BeginBlendMode(BLEND_ADDITIVE);
+        DrawTexturePro(texture, { 0, 0, (float)width, (float)height },
+            { 0, 0, (float)screenWidth, (float)screenHeight }, { 0, 0 }, 0.0f, WHITE);
+        EndBlendMode();
+    }
+
+private:
+    // Split into lead-in, interior and lead-out so the interior loop has no bounds checks
+    void BoxRow(const float* in, float* out, int radius, float inv) const {
+        float sum = 0.0f;
+        for (int x = 0; x < radius && x < width; x++) sum += in[x];
+
+        int x = 0;
+        for (; x <= radius && x < width; x++) {
+            if (x + radius < width) sum += in[x + radius];
+            out[x] = sum * inv;
+        }
+        for (; x + radius < width; x++) {
+            sum += in[x + radius] - in[x - radius - 1];
+            out[x] = sum * inv;
+        }
+        for (; x < width; x++) {
+            sum -= in[x - radius - 1];
+            out[x] = sum * inv;
+        }
+    }
+
+    float scale = 0.5f;
+    int width = 1, height = 1;
+    std::vector<float> light;    // r, g, b planes
+    std::vector<float> scratch;  // horizontal pass output
+    std::vector<float> rowSum;
+    std::vector<float> zeroRow;  // stands in for rows past the edges
+    std::vector<Color> pixels;
+    bool lit = false;            // anything splatted since Clear()
+    bool resolved = false;       // pixels hold light
+    bool uploaded = false;       // texture holds light
+
+    Texture2D texture = {};
+    bool loaded = false;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "raylib_win32.h"
+#include <cstdio>
 
 //--------------------------------------------------------------------------------------
 // HSV to RGB color conversion (helper)
@@ -52,4 +53,15 @@ inline Color ShadeCycle(float baseHue, float time, float cycleSpeed = 0.5f) {
         (unsigned char)((b + m) * 255),
         255
     };
+}
+
+//--------------------------------------------------------------------------------------
+// Lets command-line modes print when built for the Windows subsystem
+//--------------------------------------------------------------------------------------
+inline void AttachParentConsole() {
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE* stream = nullptr;
+        freopen_s(&stream, "CONOUT$", "w", stdout);
+        freopen_s(&stream, "CONOUT$", "w", stderr);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// A small pool of persistent worker threads for data-parallel loops.
+//
+// ParallelFor cuts [0, count) into chunks of `grain` items that the calling thread and
+// the workers pull from a shared counter until none are left. The body also gets a
+// slot number (0 for the caller, 1..Workers() for the threads), so callers can keep
+// per-slot scratch such as removal lists or RNG streams without locking. Loops with a
+// single chunk run inline. The body is passed by reference, so a call never allocates.
+//--------------------------------------------------------------------------------------
+class JobPool {
+public:
+    explicit JobPool(unsigned workers = DefaultWorkers()) {
+        for (unsigned i = 0; i < workers; i++)
+            threads.emplace_back(&JobPool::WorkerLoop, this, i + 1);
+    }
+
+    ~JobPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    unsigned Workers() const { return (unsigned)threads.size(); }
+    unsigned Slots() const { return Workers() + 1; }
+
+    static unsigned DefaultWorkers() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    // body(begin, end, slot) for every chunk; returns once all chunks are done
+    template <typename Body>
+    void ParallelFor(size_t count, size_t grain, Body& body) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+        size_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1 || threads.empty()) {
+            for (size_t begin = 0; begin < count; begin += grain)
+                body(begin, std::min(begin + grain, count), 0u);
+            return;
+        }
+
+        {
+            // No worker may still be inside the previous job when this one is set up
+            std::unique_lock<std::mutex> lock(mutex);
+            idle.wait(lock, [&] { return busy == 0; });
+            context = &body;
+            invoke = [](void* ctx, size_t begin, size_t end, unsigned slot) {
+                (*(Body*)ctx)(begin, end, slot);
+            };
+            total = count;
+            chunkSize = grain;
+            chunkCount = chunks;
+            next.store(0);
+            done.store(0);
+            generation++;
+        }
+        wake.notify_all();
+
+        RunChunks(0);
+        while (done.load(std::memory_order_acquire) < chunkCount)
+            std::this_thread::yield();
+    }
+
+private:
+    void WorkerLoop(unsigned slot) {
+        unsigned long long seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                busy++;
+            }
+
+            RunChunks(slot);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+            }
+            idle.notify_one();
+        }
+    }
+
+    void RunChunks(unsigned slot) {
+        size_t chunk;
+        while ((chunk = next.fetch_add(1)) < chunkCount) {
+            size_t begin = chunk * chunkSize;
+            invoke(context, begin, std::min(begin + chunkSize, total), slot);
+            done.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;   // a job was posted or the pool is stopping
+    std::condition_variable idle;   // a worker left its job
+    unsigned long long generation = 0;
+    unsigned busy = 0;
+    bool stopping = false;
+
+    // Current job; only changed while no worker is busy
+    void* context = nullptr;
+    void (*invoke)(void*, size_t, size_t, unsigned) = nullptr;
+    size_t total = 0;
+    size_t chunkSize = 1;
+    size_t chunkCount = 0;
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> done{ 0 };
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include "raylib_win32.h"
+#include "SpscRing.h"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <climits>
+
+struct PointerSample {
+    Vector2 position; // window client coordinates
+    double time;      // seconds since the sampler started
+    bool down;        // primary button held
+};
+
+//--------------------------------------------------------------------------------------
+// Pointer sampling on its own thread, independent of the frame rate.
+//
+// The thread reads the cursor every millisecond (raylib runs the system timer at 1 ms)
+// and pushes a timestamped sample into a lock-free ring whenever the position or the
+// primary button changed. That catches every report of mice polling at up to 1 kHz,
+// however long a frame takes. The main thread drains the ring once per frame.
+//
+// The button comes from GetAsyncKeyState, which reads the physical buttons, so it
+// follows the system's swapped-button setting to get the logical primary one. It sees
+// clicks meant for other windows too; callers decide from raylib's own input whether
+// the window is being drawn on and use the samples only for where the pointer went.
+//--------------------------------------------------------------------------------------
+class PointerSampler {
+public:
+    static constexpr size_t RingSize = 4096; // about four seconds of 1 kHz movement between drains
+
+    ~PointerSampler() { Stop(); }
+
+    // Stop() and Start() again to pause sampling while nobody drains the ring. Samples
+    // left from before the pause are thrown away so they never reach a new stroke.
+    void Start() {
+        if (running) return;
+        PointerSample stale;
+        while (ring.Pop(stale)) {}
+        window = GetWindowHandle();
+        running = true;
+        worker = std::thread(&PointerSampler::Run, this);
+    }
+
+    void Stop() {
+        if (!running) return;
+        running = false;
+        worker.join();
+    }
+
+    bool Running() const { return running; }
+
+    // Samples lost because the ring was full (nobody drained it for seconds)
+    size_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Moves every sample taken since the last call into out, oldest first
+    void Drain(std::vector<PointerSample>& out) {
+        out.clear();
+        PointerSample s;
+        while (ring.Pop(s)) out.push_back(s);
+    }
+
+private:
+    void Run() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+        auto start = std::chrono::steady_clock::now();
+        POINT last = { LONG_MIN, LONG_MIN };
+        bool lastDown = false;
+
+        while (running.load(std::memory_order_relaxed)) {
+            POINT p;
+            int button = GetSystemMetrics(SM_SWAPBUTTON) ? VK_RBUTTON : VK_LBUTTON;
+            bool down = (GetAsyncKeyState(button) & 0x8000) != 0;
+            if (GetCursorPos(&p) && (p.x != last.x || p.y != last.y || down != lastDown)) {
+                last = p;
+                lastDown = down;
+                ScreenToClient((HWND)window, &p);
+                std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+                if (!ring.Push({ { (float)p.x, (float)p.y }, t.count(), down }))
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            Sleep(1);
+        }
+    }
+
+    SpscRing<PointerSample, RingSize> ring;
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    std::atomic<size_t> dropped{ 0 };
+    void* window = nullptr;
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include "raylib_win32.h"
+#include "Config.h"
+#include "SparkPool.h"
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+// ======================================================
+// ShellTemplate
+// ======================================================
+// A shell type's burst, precomputed once at load: a unit velocity, a life multiplier
+// and a colour per spark. An explosion is then a scaled copy of the template into the
+// spark pool, with no trig per spark. Types without set colours (and the peony's life
+// jitter) still vary per burst: one rng draw seeds a cheap hash for every spark.
+struct ShellTemplate {
+    std::vector<float> ux, uy;       // velocity at Speed = 1
+    std::vector<float> lifeScale;
+    std::vector<Color> colors;       // empty when randomColors is set
+
+    float speed = 1.0f;              // pixels per second
+    float life = 1.0f;
+    float drag = 0.0f;               // decay rate per second
+    float gravity = 90.0f;
+    float splitTime = 0.0f;
+    bool rotate = false;             // symmetric patterns get a random spin per burst
+    bool randomColors = false;       // a new random colour per spark on every burst
+    float lifeJitter = 0.0f;         // random extra lifeScale per burst, up to this much
+
+    size_t Size() const { return ux.size(); }
+};
+
+inline ShellTemplate BuildShellTemplate(const ShellTypeConfig& cfg) {
+    ShellTemplate t;
+    t.speed = cfg.Speed;
+    t.life = cfg.Life;
+    t.drag = -logf(std::clamp(cfg.Drag, 0.001f, 1.0f)); // fraction kept per second -> rate
+    t.gravity = cfg.Gravity;
+    t.splitTime = cfg.Pattern == "crossette" ? cfg.SplitTime : 0.0f;
+
+    const int n = std::max(cfg.SparkCount, 1);
+    t.ux.resize(n); t.uy.resize(n);
+    t.lifeScale.resize(n);
+
+    if (cfg.Pattern == "ring" || cfg.Pattern == "crossette") {
+        // Evenly spaced around a circle, all at full speed
+        t.rotate = true;
+        for (int i = 0; i < n; i++) {
+            float angle = i * 2.0f * PI / n;
+            t.ux[i] = cosf(angle);
+            t.uy[i] = sinf(angle);
+            t.lifeScale[i] = 1.0f;
+        }
+    }
+    else if (cfg.Pattern == "palm") {
+        // A few heavy fronds thrown over the upper half, the top ones longest
+        for (int i = 0; i < n; i++) {
+            float angle = -PI * (0.1f + 0.8f * (i + 0.5f) / n);
+            t.ux[i] = cosf(angle);
+            t.uy[i] = sinf(angle);
+            t.lifeScale[i] = 0.8f - 0.4f * sinf(angle);
+        }
+    }
+    else {
+        // Peony: a sphere of sparks seen from the side. Points on a Fibonacci sphere,
+        // projected flat, fill the disc the way a real shell's stars do.
+        t.rotate = true;
+        const float golden = PI * (3.0f - sqrtf(5.0f));
+        for (int i = 0; i < n; i++) {
+            float z = 1.0f - 2.0f * (i + 0.5f) / n;
+            float r = sqrtf(1.0f - z * z);
+            t.ux[i] = cosf(i * golden) * r;
+            t.uy[i] = sinf(i * golden) * r;
+            t.lifeScale[i] = 0.8f;
+        }
+        t.lifeJitter = 0.4f;
+    }
+
+    t.randomColors = cfg.Colors.empty();
+    if (!t.randomColors) {
+        t.colors.resize(n);
+        for (int i = 0; i < n; i++)
+            t.colors[i] = cfg.Colors[i % cfg.Colors.size()];
+    }
+    return t;
+}
+
+// Well-mixed bits for spark k of a burst (a murmur3-style finalizer)
+inline uint32_t SparkHash(uint32_t seed, uint32_t k) {
+    uint32_t h = seed + k * 0x9e3779b9u;
+    h ^= h >> 16; h *= 0x85ebca6bu;
+    h ^= h >> 13; h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+inline std::vector<ShellTemplate> BuildShellTemplates(const std::vector<ShellTypeConfig>& types) {
+    std::vector<ShellTemplate> templates;
+    templates.reserve(types.size());
+    for (const auto& type : types)
+        templates.push_back(BuildShellTemplate(type));
+    return templates;
+}
+
+// Copies the template into slots already claimed with Allocate(). Disjoint ranges can
+// be filled on several threads, each with its own rng.
+inline void FillShell(SparkPool& pool, const ShellTemplate& t, size_t first, size_t n, float sx, float sy, std::mt19937& rng) {
+    // One rotation per burst so repeated shells don't line up
+    float c = t.speed, s = 0.0f;
+    if (t.rotate) {
+        float spin = std::uniform_real_distribution<float>(0.0f, 2.0f * PI)(rng);
+        c = cosf(spin) * t.speed;
+        s = sinf(spin) * t.speed;
+    }
+
+    const bool varies = t.randomColors || t.lifeJitter > 0.0f;
+    const uint32_t seed = varies ? (uint32_t)rng() : 0;
+
+    for (size_t k = 0; k < n; k++) {
+        size_t i = first + k;
+        uint32_t h = varies ? SparkHash(seed, (uint32_t)k) : 0;
+        pool.x[i] = sx; pool.y[i] = sy;
+        pool.vx[i] = t.ux[k] * c - t.uy[k] * s;
+        pool.vy[i] = t.ux[k] * s + t.uy[k] * c;
+        // The top byte goes to the life jitter, the low three to the colour
+        pool.life[i] = t.life * (t.lifeScale[k] + t.lifeJitter * (h >> 24) * (1.0f / 255.0f));
+        pool.drag[i] = t.drag;
+        pool.gravity[i] = t.gravity;
+        pool.fuse[i] = t.splitTime;
+        if (t.randomColors)
+            pool.color[i] = { (unsigned char)h, (unsigned char)(h >> 8), (unsigned char)(h >> 16), 255 };
+        else
+            pool.color[i] = t.colors[k];
+        pool.trailCount[i] = 0;
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include "Config.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+// ======================================================
+// ShowTimeline
+// ======================================================
+// A choreographed fireworks show read from a text file, one launch per line:
+//
+//     # time  launchX launchY  targetX targetY  shell
+//     0.0     0.5     1.0      0.5     0.3      peony
+//     1.25    0.2     1.0      0.35    0.25     ring
+//
+// time is seconds from the start of the show, positions are fractions of the screen
+// size, and shell is a ShellTypes name (anything else gets a plain random burst).
+// Blank lines, '#' comments and malformed lines are skipped.
+//
+// The file is parsed once into an event array sorted by time, and playback is a
+// cursor walking that array, so a show costs nothing per frame beyond the launches it
+// makes. Load() also works out the worst-case number of rockets in flight and sparks
+// alive at once so the caller can size its containers before the show starts. That
+// count includes a looped show's next pass overlapping the tail of the last one, and
+// room for ClickBursts click launches; more clicks than that during a busy moment can
+// find the spark pool full and lose sparks.
+struct ShowEvent {
+    float time;
+    float launchX, launchY;
+    float targetX, targetY;
+    int shell; // index into ShellTypes, -1 = random burst
+};
+
+class ShowTimeline {
+public:
+    static constexpr int ClickBursts = 4;     // click launches the peak leaves room for
+    static constexpr float LoopGap = 1.0f;    // seconds from the last launch to a restart
+
+    // burstDelay is the time from a launch to its burst (flight plus pop)
+    bool Load(const std::string& path, const FireworksSimulationConfig& config, float burstDelay, bool loop) {
+        events.clear();
+        cursor = 0;
+        clock = 0.0f;
+
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) line.erase(comment);
+
+            std::istringstream in(line);
+            ShowEvent e;
+            std::string shellName;
+            if (!(in >> e.time >> e.launchX >> e.launchY >> e.targetX >> e.targetY)) continue;
+            in >> shellName;
+
+            e.shell = -1;
+            for (size_t i = 0; i < config.ShellTypes.size(); i++)
+                if (config.ShellTypes[i].Name == shellName) e.shell = (int)i;
+            events.push_back(e);
+        }
+
+        std::stable_sort(events.begin(), events.end(),
+            [](const ShowEvent& a, const ShowEvent& b) { return a.time < b.time; });
+        duration = events.empty() ? 0.0f : events.back().time;
+
+        MeasurePeaks(config, burstDelay, loop);
+        return !events.empty();
+    }
+
+    size_t PeakRockets() const { return peakRockets; }
+    size_t PeakSparks() const { return peakSparks; }
+
+    // Advances the show clock and calls launch(event) for every event now due. With
+    // loop set the show restarts a second after its last launch.
+    template <typename LaunchFn>
+    void Update(float dt, bool loop, LaunchFn launch) {
+        if (events.empty()) return;
+        clock += dt;
+
+        while (cursor < events.size() && events[cursor].time <= clock)
+            launch(events[cursor++]);
+
+        if (loop && cursor == events.size() && clock >= duration + LoopGap) {
+            cursor = 0;
+            clock = 0.0f;
+        }
+    }
+
+private:
+    // Sparks a burst of this shell (-1 = random) can hold at once, and for how long
+    static long long BurstSparks(const FireworksSimulationConfig& config, int shell) {
+        if (shell < 0) return 50; // random bursts top out at 50
+        const auto& type = config.ShellTypes[shell];
+        // A crossette parent throws four children and keeps its own slot until it is
+        // retired, so at the split each one holds five
+        return (long long)std::max(type.SparkCount, 1) * (type.SplitTime > 0.0f && type.Pattern == "crossette" ? 5 : 1);
+    }
+
+    static float BurstLife(const FireworksSimulationConfig& config, int shell) {
+        return shell >= 0 ? config.ShellTypes[shell].Life * 1.2f : 2.0f;
+    }
+
+    // Sweeps launch/burst/burnout times to find the most rockets and sparks that can be
+    // alive at the same moment. A looped show restarts at least LoopGap after its last
+    // launch, so its passes are laid end to end at that period until no earlier pass
+    // can still have sparks alive.
+    void MeasurePeaks(const FireworksSimulationConfig& config, float burstDelay, bool loop) {
+        struct Edge { float time; long long rockets; long long sparks; };
+        std::vector<Edge> edges;
+
+        const float period = duration + LoopGap;
+        float lastBurnout = 0.0f;
+        for (const auto& e : events)
+            lastBurnout = std::max(lastBurnout, e.time + burstDelay + BurstLife(config, e.shell));
+        const int passes = loop ? 1 + (int)ceilf(lastBurnout / period) : 1;
+        edges.reserve(events.size() * 3 * passes);
+
+        for (int pass = 0; pass < passes; pass++) {
+            for (const auto& e : events) {
+                long long sparks = BurstSparks(config, e.shell);
+                float launch = e.time + pass * period;
+                float burst = launch + burstDelay;
+                edges.push_back({ launch, 1, 0 });
+                edges.push_back({ burst, -1, sparks });
+                edges.push_back({ burst + BurstLife(config, e.shell), 0, -sparks });
+            }
+        }
+
+        // Ties can be taken in either order, which at worst overcounts
+        std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.time < b.time; });
+
+        long long rockets = 0, sparks = 0;
+        peakRockets = peakSparks = 0;
+        for (const auto& edge : edges) {
+            rockets += edge.rockets;
+            sparks += edge.sparks;
+            peakRockets = std::max(peakRockets, (size_t)std::max(rockets, 0LL));
+            peakSparks = std::max(peakSparks, (size_t)std::max(sparks, 0LL));
+        }
+
+        // Clicks still launch during a show, each with a random shell type
+        long long largest = BurstSparks(config, -1);
+        for (int i = 0; i < (int)config.ShellTypes.size(); i++)
+            largest = std::max(largest, BurstSparks(config, i));
+        peakSparks += (size_t)(ClickBursts * largest);
+    }
+
+    std::vector<ShowEvent> events;
+    size_t cursor = 0;
+    float clock = 0.0f;
+    float duration = 0.0f;
+    size_t peakRockets = 0;
+    size_t peakSparks = 0;
+};
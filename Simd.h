@@ -0,0 +1,40 @@
+#pragma once
+#include <immintrin.h>
+
+//--------------------------------------------------------------------------------------
+// SIMD helpers shared by the vectorized kernels.
+//
+// Kernels are compiled for AVX2 per function and picked at runtime with CpuHasAVX2(),
+// so the binary still runs on machines that only have the x64 baseline (SSE2).
+//--------------------------------------------------------------------------------------
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define SIMD_TARGET_AVX2
+#else
+    #include <cpuid.h>
+    #define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+inline bool CpuHasAVX2() {
+    static const bool hasAVX2 = [] {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        bool fma = (info[2] & (1 << 12)) != 0;
+        if (!osxsave || !avx || !fma) return false;
+        if ((_xgetbv(0) & 0x6) != 0x6) return false; // OS saves XMM/YMM state
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }();
+    return hasAVX2;
+}
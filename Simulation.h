@@ -13,4 +13,9 @@ public:
 	virtual void Update() = 0;
 	virtual void Draw() = 0;
 	virtual void DrawUIOverlay() = 0;
+
+	// Called when the hotkeys switch to or away from this simulation. Inactive ones are
+	// kept, so anything that runs on its own (threads, timers) should pause here.
+	virtual void OnActivate() {}
+	virtual void OnDeactivate() {}
 };
\ No newline at end of file
@@ -0,0 +1,285 @@
+#pragma once
+#include "raylib_win32.h"
+#include "Simd.h"
+#include "WindField.h"
+#include <vector>
+#include <cmath>
+
+//--------------------------------------------------------------------------------------
+// Falling flakes stored as structure-of-arrays so the per-frame integration can run
+// over contiguous floats. Positions are whole pixels kept in floats; the integrator
+// writes the proposed cell for this frame into newX/newY and collision runs after it.
+// prevX/prevY hold the position before the last step, for layers that step at a
+// reduced rate and interpolate in between.
+//--------------------------------------------------------------------------------------
+struct FlakeArrays {
+    std::vector<float> x, y;
+    std::vector<float> prevX, prevY;
+    std::vector<float> vx, vy;
+    std::vector<float> gravity;
+    std::vector<float> windFactor;
+    std::vector<float> driftX;
+    std::vector<int> size;
+    std::vector<int> newX, newY;
+
+    size_t Count() const { return x.size(); }
+
+    void Push(int px, int py, float fvx, float fvy, float g, float wind, float drift, int sz) {
+        x.push_back((float)px); y.push_back((float)py);
+        prevX.push_back((float)px); prevY.push_back((float)py);
+        vx.push_back(fvx); vy.push_back(fvy);
+        gravity.push_back(g);
+        windFactor.push_back(wind);
+        driftX.push_back(drift);
+        size.push_back(sz);
+        newX.push_back(px); newY.push_back(py);
+    }
+
+    // Used for in-place compaction: copies flake src into slot dst
+    void Move(size_t dst, size_t src) {
+        if (dst == src) return;
+        x[dst] = x[src]; y[dst] = y[src];
+        prevX[dst] = prevX[src]; prevY[dst] = prevY[src];
+        vx[dst] = vx[src]; vy[dst] = vy[src];
+        gravity[dst] = gravity[src];
+        windFactor[dst] = windFactor[src];
+        driftX[dst] = driftX[src];
+        size[dst] = size[src];
+        newX[dst] = newX[src]; newY[dst] = newY[src];
+    }
+
+    void Resize(size_t n) {
+        x.resize(n); y.resize(n);
+        prevX.resize(n); prevY.resize(n);
+        vx.resize(n); vy.resize(n);
+        gravity.resize(n);
+        windFactor.resize(n);
+        driftX.resize(n);
+        size.resize(n);
+        newX.resize(n); newY.resize(n);
+    }
+};
+
+struct FlakeStepParams {
+    float dt;
+    float baseWind;       // global gust added on top of the field
+    Vector2 mouse;
+    float avoidRadius;
+    float avoidStrength;
+};
+
+//--------------------------------------------------------------------------------------
+// Scalar reference integrator. Also handles the tail the vector paths leave over.
+//--------------------------------------------------------------------------------------
+inline void IntegrateFlakesScalar(FlakeArrays& f, const WindField& wind, const FlakeStepParams& p, size_t begin, size_t end) {
+    const float r2 = p.avoidRadius * p.avoidRadius;
+
+    for (size_t i = begin; i < end; i++) {
+        Vector2 w = wind.Sample(f.x[i], f.y[i]);
+
+        f.vx[i] += (f.driftX[i] * 0.1f) * p.dt;
+        f.vx[i] += ((p.baseWind + w.x) * f.windFactor[i]) * p.dt;
+        f.vy[i] += (f.gravity[i] + w.y * f.windFactor[i]) * p.dt;
+
+        // Mouse avoidance
+        float dx = f.x[i] - p.mouse.x;
+        float dy = f.y[i] - p.mouse.y;
+        float distSq = dx * dx + dy * dy;
+
+        if (distSq < r2 && distSq > 1.0f) {
+            float dist = sqrtf(distSq);
+            float factor = (p.avoidRadius - dist) / p.avoidRadius;
+            f.vx[i] += (dx / dist) * p.avoidStrength * p.dt * factor;
+            if (dy < 0) {
+                f.vy[i] += (dy / dist) * (p.avoidStrength * 0.2f) * p.dt * factor;
+            }
+        }
+
+        f.newX[i] = (int)(f.x[i] + nearbyintf(f.vx[i]));
+        f.newY[i] = (int)(f.y[i] + nearbyintf(f.vy[i]));
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// AVX2: eight flakes per iteration, wind corners fetched with gathers.
+// Returns how many flakes were processed; the caller finishes the tail.
+//--------------------------------------------------------------------------------------
+SIMD_TARGET_AVX2 inline size_t IntegrateFlakesAVX2(FlakeArrays& f, const WindField& wind, const FlakeStepParams& p) {
+    const size_t n = f.Count();
+    const __m256 dt = _mm256_set1_ps(p.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 driftScale = _mm256_set1_ps(0.1f * p.dt);
+    const __m256 baseWind = _mm256_set1_ps(p.baseWind);
+    const __m256 invCell = _mm256_set1_ps(1.0f / wind.cellSize);
+    const __m256 maxGx = _mm256_set1_ps(wind.cols - 1.001f);
+    const __m256 maxGy = _mm256_set1_ps(wind.rows - 1.001f);
+    const __m256i cols = _mm256_set1_epi32(wind.cols);
+    const __m256 mouseX = _mm256_set1_ps(p.mouse.x);
+    const __m256 mouseY = _mm256_set1_ps(p.mouse.y);
+    const __m256 radius = _mm256_set1_ps(p.avoidRadius);
+    const __m256 radiusSq = _mm256_set1_ps(p.avoidRadius * p.avoidRadius);
+    const __m256 push = _mm256_set1_ps(p.avoidStrength * p.dt / p.avoidRadius);
+    const __m256 pushUp = _mm256_set1_ps(p.avoidStrength * 0.2f * p.dt / p.avoidRadius);
+    const float* u = wind.u.data();
+    const float* v = wind.v.data();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(&f.x[i]);
+        __m256 y = _mm256_loadu_ps(&f.y[i]);
+        __m256 vx = _mm256_loadu_ps(&f.vx[i]);
+        __m256 vy = _mm256_loadu_ps(&f.vy[i]);
+        __m256 windFactor = _mm256_loadu_ps(&f.windFactor[i]);
+
+        // Bilinear wind sample
+        __m256 gx = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(x, invCell), zero), maxGx);
+        __m256 gy = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(y, invCell), zero), maxGy);
+        __m256 gx0 = _mm256_floor_ps(gx);
+        __m256 gy0 = _mm256_floor_ps(gy);
+        __m256 fx = _mm256_sub_ps(gx, gx0);
+        __m256 fy = _mm256_sub_ps(gy, gy0);
+        __m256i node = _mm256_add_epi32(
+            _mm256_mullo_epi32(_mm256_cvttps_epi32(gy0), cols), _mm256_cvttps_epi32(gx0));
+        __m256i nodeBelow = _mm256_add_epi32(node, cols);
+
+        __m256 u00 = _mm256_i32gather_ps(u, node, 4);
+        __m256 u10 = _mm256_i32gather_ps(u + 1, node, 4);
+        __m256 u01 = _mm256_i32gather_ps(u, nodeBelow, 4);
+        __m256 u11 = _mm256_i32gather_ps(u + 1, nodeBelow, 4);
+        __m256 v00 = _mm256_i32gather_ps(v, node, 4);
+        __m256 v10 = _mm256_i32gather_ps(v + 1, node, 4);
+        __m256 v01 = _mm256_i32gather_ps(v, nodeBelow, 4);
+        __m256 v11 = _mm256_i32gather_ps(v + 1, nodeBelow, 4);
+
+        __m256 uTop = _mm256_fmadd_ps(_mm256_sub_ps(u10, u00), fx, u00);
+        __m256 uBottom = _mm256_fmadd_ps(_mm256_sub_ps(u11, u01), fx, u01);
+        __m256 vTop = _mm256_fmadd_ps(_mm256_sub_ps(v10, v00), fx, v00);
+        __m256 vBottom = _mm256_fmadd_ps(_mm256_sub_ps(v11, v01), fx, v01);
+        __m256 wu = _mm256_fmadd_ps(_mm256_sub_ps(uBottom, uTop), fy, uTop);
+        __m256 wv = _mm256_fmadd_ps(_mm256_sub_ps(vBottom, vTop), fy, vTop);
+
+        // Drift, wind and gravity
+        vx = _mm256_fmadd_ps(_mm256_loadu_ps(&f.driftX[i]), driftScale, vx);
+        vx = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_add_ps(baseWind, wu), windFactor), dt, vx);
+        vy = _mm256_fmadd_ps(_mm256_fmadd_ps(wv, windFactor, _mm256_loadu_ps(&f.gravity[i])), dt, vy);
+
+        // Mouse avoidance, only when a lane is inside the radius
+        __m256 dx = _mm256_sub_ps(x, mouseX);
+        __m256 dy = _mm256_sub_ps(y, mouseY);
+        __m256 distSq = _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx));
+        __m256 inside = _mm256_and_ps(
+            _mm256_cmp_ps(distSq, radiusSq, _CMP_LT_OQ), _mm256_cmp_ps(distSq, one, _CMP_GT_OQ));
+        if (_mm256_movemask_ps(inside)) {
+            __m256 dist = _mm256_sqrt_ps(distSq);
+            __m256 scale = _mm256_div_ps(_mm256_sub_ps(radius, dist), dist); // factor / dist * radius
+            __m256 above = _mm256_and_ps(inside, _mm256_cmp_ps(dy, zero, _CMP_LT_OQ));
+            vx = _mm256_add_ps(vx, _mm256_and_ps(inside, _mm256_mul_ps(_mm256_mul_ps(dx, scale), push)));
+            vy = _mm256_add_ps(vy, _mm256_and_ps(above, _mm256_mul_ps(_mm256_mul_ps(dy, scale), pushUp)));
+        }
+
+        _mm256_storeu_ps(&f.vx[i], vx);
+        _mm256_storeu_ps(&f.vy[i], vy);
+
+        const int roundMode = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+        _mm256_storeu_si256((__m256i*)&f.newX[i], _mm256_cvttps_epi32(_mm256_add_ps(x, _mm256_round_ps(vx, roundMode))));
+        _mm256_storeu_si256((__m256i*)&f.newY[i], _mm256_cvttps_epi32(_mm256_add_ps(y, _mm256_round_ps(vy, roundMode))));
+    }
+    return i;
+}
+
+//--------------------------------------------------------------------------------------
+// SSE2 fallback: four flakes per iteration. SSE2 has no gather, so the wind corners
+// are loaded per lane and the interpolation is vectorized.
+//--------------------------------------------------------------------------------------
+inline size_t IntegrateFlakesSSE(FlakeArrays& f, const WindField& wind, const FlakeStepParams& p) {
+    const size_t n = f.Count();
+    const __m128 dt = _mm_set1_ps(p.dt);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 driftScale = _mm_set1_ps(0.1f * p.dt);
+    const __m128 baseWind = _mm_set1_ps(p.baseWind);
+    const __m128 invCell = _mm_set1_ps(1.0f / wind.cellSize);
+    const __m128 maxGx = _mm_set1_ps(wind.cols - 1.001f);
+    const __m128 maxGy = _mm_set1_ps(wind.rows - 1.001f);
+    const __m128 mouseX = _mm_set1_ps(p.mouse.x);
+    const __m128 mouseY = _mm_set1_ps(p.mouse.y);
+    const __m128 radius = _mm_set1_ps(p.avoidRadius);
+    const __m128 radiusSq = _mm_set1_ps(p.avoidRadius * p.avoidRadius);
+    const __m128 push = _mm_set1_ps(p.avoidStrength * p.dt / p.avoidRadius);
+    const __m128 pushUp = _mm_set1_ps(p.avoidStrength * 0.2f * p.dt / p.avoidRadius);
+    const float* u = wind.u.data();
+    const float* v = wind.v.data();
+    const int cols = wind.cols;
+
+    alignas(16) int gi[4], gj[4];
+    alignas(16) float c[8][4];
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(&f.x[i]);
+        __m128 y = _mm_loadu_ps(&f.y[i]);
+        __m128 vx = _mm_loadu_ps(&f.vx[i]);
+        __m128 vy = _mm_loadu_ps(&f.vy[i]);
+        __m128 windFactor = _mm_loadu_ps(&f.windFactor[i]);
+
+        // Clamped grid coordinates are non-negative, so truncation is floor
+        __m128 gx = _mm_min_ps(_mm_max_ps(_mm_mul_ps(x, invCell), zero), maxGx);
+        __m128 gy = _mm_min_ps(_mm_max_ps(_mm_mul_ps(y, invCell), zero), maxGy);
+        __m128i ix = _mm_cvttps_epi32(gx);
+        __m128i iy = _mm_cvttps_epi32(gy);
+        __m128 fx = _mm_sub_ps(gx, _mm_cvtepi32_ps(ix));
+        __m128 fy = _mm_sub_ps(gy, _mm_cvtepi32_ps(iy));
+        _mm_store_si128((__m128i*)gi, ix);
+        _mm_store_si128((__m128i*)gj, iy);
+
+        for (int l = 0; l < 4; l++) {
+            size_t node = (size_t)gj[l] * cols + gi[l];
+            c[0][l] = u[node];        c[1][l] = u[node + 1];
+            c[2][l] = u[node + cols]; c[3][l] = u[node + cols + 1];
+            c[4][l] = v[node];        c[5][l] = v[node + 1];
+            c[6][l] = v[node + cols]; c[7][l] = v[node + cols + 1];
+        }
+
+        auto lerp = [](__m128 a, __m128 b, __m128 t) { return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)); };
+        __m128 uTop = lerp(_mm_load_ps(c[0]), _mm_load_ps(c[1]), fx);
+        __m128 uBottom = lerp(_mm_load_ps(c[2]), _mm_load_ps(c[3]), fx);
+        __m128 vTop = lerp(_mm_load_ps(c[4]), _mm_load_ps(c[5]), fx);
+        __m128 vBottom = lerp(_mm_load_ps(c[6]), _mm_load_ps(c[7]), fx);
+        __m128 wu = lerp(uTop, uBottom, fy);
+        __m128 wv = lerp(vTop, vBottom, fy);
+
+        // Drift, wind and gravity
+        vx = _mm_add_ps(vx, _mm_mul_ps(_mm_loadu_ps(&f.driftX[i]), driftScale));
+        vx = _mm_add_ps(vx, _mm_mul_ps(_mm_mul_ps(_mm_add_ps(baseWind, wu), windFactor), dt));
+        vy = _mm_add_ps(vy, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&f.gravity[i]), _mm_mul_ps(wv, windFactor)), dt));
+
+        // Mouse avoidance
+        __m128 dx = _mm_sub_ps(x, mouseX);
+        __m128 dy = _mm_sub_ps(y, mouseY);
+        __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 inside = _mm_and_ps(_mm_cmplt_ps(distSq, radiusSq), _mm_cmpgt_ps(distSq, one));
+        if (_mm_movemask_ps(inside)) {
+            __m128 dist = _mm_sqrt_ps(distSq);
+            __m128 scale = _mm_div_ps(_mm_sub_ps(radius, dist), dist);
+            __m128 above = _mm_and_ps(inside, _mm_cmplt_ps(dy, zero));
+            vx = _mm_add_ps(vx, _mm_and_ps(inside, _mm_mul_ps(_mm_mul_ps(dx, scale), push)));
+            vy = _mm_add_ps(vy, _mm_and_ps(above, _mm_mul_ps(_mm_mul_ps(dy, scale), pushUp)));
+        }
+
+        _mm_storeu_ps(&f.vx[i], vx);
+        _mm_storeu_ps(&f.vy[i], vy);
+
+        // cvtps rounds to nearest under the default MXCSR mode, matching nearbyintf
+        _mm_storeu_si128((__m128i*)&f.newX[i], _mm_add_epi32(_mm_cvttps_epi32(x), _mm_cvtps_epi32(vx)));
+        _mm_storeu_si128((__m128i*)&f.newY[i], _mm_add_epi32(_mm_cvttps_epi32(y), _mm_cvtps_epi32(vy)));
+    }
+    return i;
+}
+
+inline void IntegrateFlakes(FlakeArrays& f, const WindField& wind, const FlakeStepParams& p) {
+    size_t done = CpuHasAVX2()
+        ? IntegrateFlakesAVX2(f, wind, p)
+        : IntegrateFlakesSSE(f, wind, p);
+    IntegrateFlakesScalar(f, wind, p, done, f.Count());
+}
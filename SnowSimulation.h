@@ -3,6 +3,11 @@
 #include "Helper.h"
 #include "Simulation.h"
 #include "Config.h"
+#include "WindField.h"
+#include "SnowKernels.h"
+#include "FlakeAtlas.h"
+#include <vector>
+#include <algorithm>
 
 extern ConfigManager configManager;
 
@@ -12,15 +17,6 @@ public:
         : x(px), y(py), gridIndex(idx), velocity{ 0,0 }, color(c), size(sz) {
     }
 
-    void Draw() const {
-        if (size <= 1) {
-            DrawPixel(x, y, Fade(color, alpha));
-        }
-        else {
-            DrawCircle(x, y, (float)size * 0.5f, Fade(color, alpha));
-        }
-    }
-
     int x, y;
     int gridIndex;
     Vector2 velocity;
@@ -37,13 +33,40 @@ public:
     float driftX = 0.0f;
 };
 
+//--------------------------------------------------------------------------------------
+// Parallax background layer. Its flakes never settle: they step every UpdateDivisor
+// frames (positions interpolated in between), fall through the floor, and are drawn
+// into a reduced resolution buffer that gets upscaled behind the near layer.
+//--------------------------------------------------------------------------------------
+struct SnowLayer {
+    SnowLayerConfig cfg;
+    FlakeArrays flakes;
+    RenderTexture2D target = {};
+    float spawnTimer = 0.0f;
+    float stepTime = 0.0f;   // dt accumulated since the last step
+    int framesSinceStep = 0;
+};
+
 class SnowSimulation : public ISimulation {
 private:
-    std::vector<uint8_t> occupancy;
-    std::vector<Snowflake> dynamicFlakes;
+    // Snow ground as a per-column depth map: column x is solid from row
+    // (floor - snowDepth[x]) down to the floor. Landing is one lookup per column.
+    // The depth is always the sum of the landed flakes' footprints, so the ground is
+    // exactly the snow that is drawn.
+    std::vector<int> snowDepth;
+    bool avalancheLeftToRight = true;
+    FlakeArrays dynamicFlakes;
     std::vector<Snowflake> staticFlakes;
+    std::vector<int> topFlake;   // per column, the highest landed flake centred there (-1: none)
     //RenderTexture2D staticLayer;
 
+    SnowLayer farLayer;
+    SnowLayer midLayer;
+
+    FlakeAtlas flakeAtlas;
+    WindField windField;
+    float windUpdateTimer = 0.0f;
+
     float spawnTimer = 0.0f;
     float gustTimer = 0.0f;
     float windForce = 0.0f;
@@ -56,7 +79,8 @@ public:
         width = GetScreenWidth();
         height = GetScreenHeight();
 
-        occupancy.resize(width * height, 0);
+        snowDepth.resize(width, 0);
+        topFlake.resize(width, -1);
         //staticLayer = LoadRenderTexture(width, height);
 
         //BeginTextureMode(staticLayer);
@@ -67,12 +91,236 @@ public:
         SetWindowTitle(WindowTitle.c_str());
 
 		config = configManager.GetConfig()->SnowSimConfig;
+
+        flakeAtlas.Load(config.MinFlakeSize, config.MaxFlakeSize);
+        windField.Resize(width, height, config.WindFieldCellSize);
+        windField.Update(GetTime(), config.WindFieldStrength);
+
+        InitLayer(farLayer, config.FarLayer);
+        InitLayer(midLayer, config.MidLayer);
     }
 
     ~SnowSimulation() {
+        UnloadRenderTexture(farLayer.target);
+        UnloadRenderTexture(midLayer.target);
+        flakeAtlas.Unload();
         //UnloadRenderTexture(staticLayer);
     }
 
+private:
+    enum class SweepResult { Clear, Landed, OutOfBounds };
+
+    //--------------------------------------------------------------------------------------
+    // A landed flake raises the ground across its footprint by half its chord at each
+    // column, so a size-6 flake builds a small mound instead of a single pixel.
+    // Melting and sliding subtract the same profile.
+    //--------------------------------------------------------------------------------------
+    void DepositFlake(int x, int size, int sign) {
+        float r = size * 0.5f;
+        int reach = (int)r;
+        for (int dx = -reach; dx <= reach; dx++) {
+            int cx = x + dx;
+            if (cx < 0 || cx >= width) continue;
+            int raise = std::max(1, (int)roundf(sqrtf(r * r - (float)(dx * dx))));
+            snowDepth[cx] = std::max(0, snowDepth[cx] + sign * raise);
+        }
+    }
+
+    // Where a flake rests: on the snow in its column, not counting its own share of it
+    int RestY(const Snowflake& f, int floorY) const {
+        int own = std::max(1, (int)roundf(f.size * 0.5f));
+        return floorY - (snowDepth[f.x] - own) - 1;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // 1D talus pass: wherever neighbouring columns differ by more than DriftSlope, the
+    // top flake of the higher column slides one column down the slope, taking its
+    // footprint with it. At most one flake leaves a column per frame. Alternating the
+    // sweep direction keeps drifts from creeping one way.
+    //
+    // Before that, every flake drops onto what is under it now, since melting takes snow
+    // out from under the flakes above.
+    //--------------------------------------------------------------------------------------
+    void SettleDrifts(int floorY) {
+        std::fill(topFlake.begin(), topFlake.end(), -1);
+        for (int k = 0; k < (int)staticFlakes.size(); k++) {
+            Snowflake& f = staticFlakes[k];
+            f.y = std::max(f.y, RestY(f, floorY));
+            int& top = topFlake[f.x];
+            if (top < 0 || f.y < staticFlakes[top].y) top = k;
+        }
+        if (config.DriftSlope <= 0 || width < 2) return;
+
+        for (int n = 0; n < width - 1; n++) {
+            int i = avalancheLeftToRight ? n : width - 2 - n;
+            int diff = snowDepth[i] - snowDepth[i + 1];
+            if (diff > config.DriftSlope) SlideFlake(i, i + 1, floorY);
+            else if (-diff > config.DriftSlope) SlideFlake(i + 1, i, floorY);
+        }
+        avalancheLeftToRight = !avalancheLeftToRight;
+    }
+
+    void SlideFlake(int from, int to, int floorY) {
+        int k = topFlake[from];
+        if (k < 0) return;
+        Snowflake& f = staticFlakes[k];
+        DepositFlake(f.x, f.size, -1);
+        f.x = to;
+        DepositFlake(f.x, f.size, +1);
+        f.y = RestY(f, floorY);
+        f.gridIndex = f.y * width + f.x;
+        topFlake[from] = -1;
+        topFlake[to] = k;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Swept collision: walks the DDA path from (x0,y0) to (x1,y1) one vertical run per
+    // column and stops where the run reaches that column's snow surface, so fast flakes
+    // can't tunnel through thin drifts. (outX,outY) is the last free cell along the path.
+    //--------------------------------------------------------------------------------------
+    SweepResult SweepFlake(int x0, int y0, int x1, int y1, int floorY, int& outX, int& outY) const {
+        outX = x0; outY = y0;
+
+        int dx = x1 - x0, dy = y1 - y0;
+        int steps = std::max(abs(dx), abs(dy));
+        if (steps == 0) return SweepResult::Clear;
+
+        int minX = std::min(x0, x1), maxX = std::max(x0, x1);
+        int maxY = std::max(y0, y1);
+
+        // Fast path: the segment lies entirely above the snow in every column it crosses
+        if (minX >= 0 && maxX < width) {
+            bool clear = true;
+            for (int cx = minX; cx <= maxX && clear; cx++)
+                clear = maxY < floorY - snowDepth[cx];
+            if (clear) {
+                outX = x1; outY = y1;
+                return SweepResult::Clear;
+            }
+        }
+
+        auto at = [steps](int i, int d) { return (int)floorf(d * (float)i / steps + 0.5f); };
+        int dirY = (dy > 0) - (dy < 0);
+        int prevX = x0, prevY = y0;
+
+        for (int i = 1; i <= steps;) {
+            int cx = x0 + at(i, dx);
+            int j = i;
+            while (j < steps && x0 + at(j + 1, dx) == cx) j++;
+
+            int runStartY = y0 + at(i, dy);
+            int runEndY = y0 + at(j, dy);
+
+            if (cx < 0 || cx >= width) return SweepResult::OutOfBounds;
+
+            // Ground is solid below the surface, so the first solid cell of the run is
+            // either where it starts or where it crosses the surface.
+            int surfaceY = floorY - snowDepth[cx];
+            if (std::max(runStartY, runEndY) >= surfaceY) {
+                int hitY = std::max(runStartY, surfaceY);
+                if (dirY < 0 || hitY == runStartY) {
+                    outX = prevX; outY = prevY;
+                }
+                else {
+                    outX = cx; outY = hitY - 1;
+                }
+                return SweepResult::Landed;
+            }
+
+            prevX = cx; prevY = runEndY;
+            i = j + 1;
+        }
+
+        outX = x1; outY = y1;
+        return SweepResult::Clear;
+    }
+
+    void InitLayer(SnowLayer& layer, const SnowLayerConfig& cfg) {
+        layer.cfg = cfg;
+        layer.cfg.UpdateDivisor = std::max(1, cfg.UpdateDivisor);
+        layer.cfg.RenderScale = Clamp(cfg.RenderScale, 0.1f, 1.0f);
+        layer.target = LoadRenderTexture(
+            std::max(1, (int)(width * layer.cfg.RenderScale)),
+            std::max(1, (int)(height * layer.cfg.RenderScale)));
+        SetTextureFilter(layer.target.texture, TEXTURE_FILTER_BILINEAR);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Steps a background layer. Velocities are kept in pixels per step rather than per
+    // frame, so gravity, wind and drift are pre-multiplied by the divisor at spawn and
+    // the shared integrator runs unchanged on the accumulated dt.
+    //--------------------------------------------------------------------------------------
+    void UpdateLayer(SnowLayer& layer, float dt, int floorY) {
+        const int divisor = layer.cfg.UpdateDivisor;
+        const float depth = layer.cfg.Depth;
+
+        layer.spawnTimer += dt;
+        int spawns = 0;
+        while (layer.cfg.SpawnInterval > 0.0f && layer.spawnTimer > layer.cfg.SpawnInterval && spawns++ < 64) {
+            layer.spawnTimer -= layer.cfg.SpawnInterval;
+
+            int px = GetRandomValue(0, width - 1);
+            int size = GetRandomValue(config.MinFlakeSize, config.MaxFlakeSize);
+            float scale = depth * divisor;
+            float gravity = (0.3f + (0.6f / size)) * (GetRandomValue(80, 120) / 100.0f) * scale;
+            float windFactor = GetRandomValue(50, 150) / 100.0f * scale;
+            float driftX = (GetRandomValue(-100, 100) / 100.0f) * 0.3f * scale;
+
+            layer.flakes.Push(px, 0, driftX, gravity, gravity, windFactor, driftX, size);
+        }
+        if (layer.spawnTimer > layer.cfg.SpawnInterval) layer.spawnTimer = 0.0f;
+
+        layer.stepTime += dt;
+        if (++layer.framesSinceStep < divisor) return;
+
+        FlakeStepParams step = {};
+        step.dt = layer.stepTime;
+        step.baseWind = windForce;
+        IntegrateFlakes(layer.flakes, windField, step);
+
+        FlakeArrays& f = layer.flakes;
+        size_t kept = 0;
+        for (size_t i = 0; i < f.Count(); i++) {
+            int newX = f.newX[i], newY = f.newY[i];
+            if (newX < 0 || newX >= width || newY >= floorY) continue;
+
+            f.prevX[i] = f.x[i]; f.prevY[i] = f.y[i];
+            f.x[i] = (float)newX; f.y[i] = (float)newY;
+            f.Move(kept++, i);
+        }
+        f.Resize(kept);
+
+        layer.stepTime = 0.0f;
+        layer.framesSinceStep = 0;
+    }
+
+    // Renders a layer into its low resolution buffer, interpolating between steps
+    void RenderLayer(SnowLayer& layer) {
+        const FlakeArrays& f = layer.flakes;
+        const float scale = layer.cfg.RenderScale;
+        const float t = (float)layer.framesSinceStep / layer.cfg.UpdateDivisor;
+        const unsigned char alpha = (unsigned char)(255 * Clamp(0.3f + 0.7f * layer.cfg.Depth, 0.0f, 1.0f));
+
+        BeginTextureMode(layer.target);
+        ClearBackground(BLANK);
+        flakeAtlas.Begin();
+        for (size_t i = 0; i < f.Count(); i++) {
+            float x = f.prevX[i] + (f.x[i] - f.prevX[i]) * t;
+            float y = f.prevY[i] + (f.y[i] - f.prevY[i]) * t;
+            int size = std::max(1, (int)roundf(f.size[i] * layer.cfg.Depth * scale));
+            flakeAtlas.Add(x * scale, y * scale, size, { 255, 255, 255, alpha });
+        }
+        flakeAtlas.End();
+        EndTextureMode();
+    }
+
+    void DrawLayer(const SnowLayer& layer) const {
+        const Texture2D& tex = layer.target.texture;
+        DrawTexturePro(tex, { 0, 0, (float)tex.width, -(float)tex.height },
+            { 0, 0, (float)width, (float)height }, { 0, 0 }, 0.0f, WHITE);
+    }
+
+public:
     void Update() override {
 		width = GetScreenWidth();
 		height = GetScreenHeight();
@@ -94,6 +342,13 @@ public:
         }
         windForce += (targetWindForce - windForce) * 0.5f * dt;
 
+        // The field only needs to evolve a few times per second
+        windUpdateTimer += dt;
+        if (config.WindFieldUpdateRate > 0.0f && windUpdateTimer >= 1.0f / config.WindFieldUpdateRate) {
+            windUpdateTimer = 0.0f;
+            windField.Update(now, config.WindFieldStrength);
+        }
+
         // Spawn flakes
         if (spawnTimer > config.SpawnInterval) {
             spawnTimer = 0.0f;
@@ -101,79 +356,65 @@ public:
             int py = 0;
             int size = GetRandomValue(config.MinFlakeSize, config.MaxFlakeSize);
 
-            Snowflake flake(px, py, WHITE, py * width + px, size);
             float baseFall = 0.3f + (0.6f / size);
-            flake.gravity = baseFall * (GetRandomValue(80, 120) / 100.0f);
-            flake.windFactor = GetRandomValue(50, 150) / 100.0f;
-            flake.driftX = (GetRandomValue(-100, 100) / 100.0f) * 0.3f;
-            flake.velocity = { flake.driftX, flake.gravity };
+            float gravity = baseFall * (GetRandomValue(80, 120) / 100.0f);
+            float windFactor = GetRandomValue(50, 150) / 100.0f;
+            float driftX = (GetRandomValue(-100, 100) / 100.0f) * 0.3f;
 
-            dynamicFlakes.push_back(flake);
+            dynamicFlakes.Push(px, py, driftX, gravity, gravity, windFactor, driftX, size);
         }
 
-        // Update dynamics
-        std::vector<Snowflake> stillDynamic;
-        Vector2 mousePos = GetCursorPosition();
-
-        for (auto& f : dynamicFlakes) {
-            // Physics
-            f.velocity.x += (f.driftX * 0.1f) * dt;
-            f.velocity.x += (windForce * f.windFactor) * dt;
-            f.velocity.y += f.gravity * dt;
-
-            // Mouse avoidance
-            float dx = (float)f.x - mousePos.x;
-            float dy = (float)f.y - mousePos.y;
-            float distSq = dx * dx + dy * dy;
-
-            if (distSq < config.MouseAvoidRadius * config.MouseAvoidRadius && distSq > 1.0f) {
-                float dist = sqrtf(distSq);
-                float factor = (config.MouseAvoidRadius - dist) / config.MouseAvoidRadius;
-                f.velocity.x += (dx / dist) * config.MouseAvoidStrength * dt * factor;
-                if (dy < 0) {
-                    f.velocity.y += (dy / dist) * (config.MouseAvoidStrength * 0.2f) * dt * factor;
-                }
-            }
-
-            int newX = f.x + (int)roundf(f.velocity.x);
-            int newY = f.y + (int)roundf(f.velocity.y);
-
-            bool landed = false;
-
-            if (newY >= taskbar_height) {
-                landed = true;
-            }
-            else {
-                int idx = newY * width + newX;
-                if (idx >= 0 && idx < occupancy.size() && occupancy[idx] != 0) {
-                    landed = true;
-                }
-            }
-
-            if (!landed) {
+        // Background layers run at their own rate
+        UpdateLayer(farLayer, dt, taskbar_height);
+        UpdateLayer(midLayer, dt, taskbar_height);
+        RenderLayer(farLayer);
+        RenderLayer(midLayer);
+
+        // Physics for every falling flake, vectorized
+        FlakeStepParams step = {};
+        step.dt = dt;
+        step.baseWind = windForce;
+        step.mouse = GetCursorPosition();
+        step.avoidRadius = config.MouseAvoidRadius;
+        step.avoidStrength = config.MouseAvoidStrength;
+        IntegrateFlakes(dynamicFlakes, windField, step);
+
+        // Collision, compacting the survivors in place
+        FlakeArrays& f = dynamicFlakes;
+        size_t kept = 0;
+        for (size_t i = 0; i < f.Count(); i++) {
+            int x = (int)f.x[i], y = (int)f.y[i];
+            int newX = f.newX[i], newY = f.newY[i];
+
+            int stopX, stopY;
+            SweepResult sweep = SweepFlake(x, y, newX, newY, taskbar_height, stopX, stopY);
+
+            if (sweep == SweepResult::Clear) {
                 // Out of bounds
                 if (newX < 0 || newX >= width || newY < 0 || newY >= height) {
-                    f.landedTime = now;
-                    f.fadeStartTime = now; // fade immediately
-                    f.alpha = 0.0f;
-                    staticFlakes.push_back(f);
                     continue;
                 }
-                f.x = newX; f.y = newY;
-                f.gridIndex = f.y * width + f.x;
-                stillDynamic.push_back(f);
+                f.x[i] = (float)newX; f.y[i] = (float)newY;
+                f.Move(kept++, i);
             }
-            else {
-                int idx = f.y * width + f.x;
-                if (idx >= 0 && idx < occupancy.size()) {
-                    occupancy[idx] = 1;
-                }
-                f.landedTime = now;
-                f.fadeStartTime = now + config.FadeDelay;
-                staticFlakes.push_back(f);
+            else if (sweep == SweepResult::Landed) {
+                if (stopY < 0) continue; // the snow has reached the top of the screen
+
+                Snowflake flake(stopX, stopY, WHITE, stopY * width + stopX, f.size[i]);
+                flake.velocity = { f.vx[i], f.vy[i] };
+                flake.gravity = f.gravity[i];
+                flake.windFactor = f.windFactor[i];
+                flake.driftX = f.driftX[i];
+                flake.landedTime = now;
+                flake.fadeStartTime = now + config.FadeDelay;
+
+                DepositFlake(stopX, flake.size, +1);
+                staticFlakes.push_back(flake);
             }
         }
-        dynamicFlakes = stillDynamic;
+        f.Resize(kept);
+
+        SettleDrifts(taskbar_height);
 
         // Fade static flakes
         for (auto& f : staticFlakes) {
@@ -185,7 +426,7 @@ public:
             std::remove_if(staticFlakes.begin(), staticFlakes.end(),
                 [&](const Snowflake& f) {
                     if (f.alpha <= 0.0f) {
-                        occupancy[f.gridIndex] = 0; // clear occupancy only when removing
+                        DepositFlake(f.x, f.size, -1); // melt only when removing
                         return true;
                     }
                     return false;
@@ -195,20 +436,33 @@ public:
     }
 
     void Draw() override {
-        for (auto& f : staticFlakes) f.Draw();
-        for (auto& f : dynamicFlakes) f.Draw();
+        DrawLayer(farLayer);
+        DrawLayer(midLayer);
+
+        // Every near flake is one quad in a single batch
+        flakeAtlas.Begin();
+        for (auto& f : staticFlakes) {
+            unsigned char a = (unsigned char)(f.color.a * Clamp(f.alpha, 0.0f, 1.0f));
+            flakeAtlas.Add((float)f.x, (float)f.y, f.size, { f.color.r, f.color.g, f.color.b, a });
+        }
+
+        const FlakeArrays& f = dynamicFlakes;
+        for (size_t i = 0; i < f.Count(); i++)
+            flakeAtlas.Add(f.x[i], f.y[i], f.size[i], WHITE);
+        flakeAtlas.End();
     }
 
     void DrawUIOverlay() override {
         if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)
             || IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)) {
-            DrawRectangle(10, 10, 280, 135, Color{ 0, 0, 0, 150 });
-            DrawText(TextFormat("Dynamic flakes: %d", dynamicFlakes.size()), 20, 20, 10, LIGHTGRAY);
-            DrawText(TextFormat("Static flakes: %d", staticFlakes.size()), 20, 35, 10, LIGHTGRAY);
+            DrawRectangle(10, 10, 280, 150, Color{ 0, 0, 0, 150 });
+            DrawText(TextFormat("Dynamic flakes: %d", (int)dynamicFlakes.Count()), 20, 20, 10, LIGHTGRAY);
+            DrawText(TextFormat("Static flakes: %d", (int)staticFlakes.size()), 20, 35, 10, LIGHTGRAY);
             DrawText(TextFormat("MinSize: %d, MaxSize: %d", config.MinFlakeSize, config.MaxFlakeSize), 20, 50, 10, YELLOW);
             DrawText(TextFormat("SpawnInterval: %.3f", config.SpawnInterval), 20, 65, 10, YELLOW);
             DrawText(TextFormat("FadeDelay: %.0fs", config.FadeDelay), 20, 80, 10, YELLOW);
-            DrawText(std::string("FPS: " + std::to_string(GetFPS())).c_str(), 20, 95, 10, GREEN);
+            DrawText(TextFormat("Far flakes: %d, Mid flakes: %d", (int)farLayer.flakes.Count(), (int)midLayer.flakes.Count()), 20, 95, 10, LIGHTGRAY);
+            DrawText(std::string("FPS: " + std::to_string(GetFPS())).c_str(), 20, 110, 10, GREEN);
         }
     }
 };
\ No newline at end of file
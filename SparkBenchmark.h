@@ -0,0 +1,102 @@
+#pragma once
+#include "SparkPool.h"
+#include "SparkKernels.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+
+// ======================================================
+// Spark integration microbenchmark (--bench-sparks)
+// ======================================================
+// Checks the AVX2 kernel against the scalar reference, then reports how many spark
+// updates per second each path sustains on this CPU.
+
+namespace SparkBenchmark {
+    constexpr size_t SparkCount = 1 << 16;
+    constexpr int Frames = 500;
+    constexpr float Dt = 1.0f / 60.0f;
+
+    inline void Fill(SparkPool& pool) {
+        pool.Reserve(SparkCount);
+        pool.count = 0;
+        pool.trailHead = 0;
+        while (pool.Free() > 0) pool.Emit(960.0f, 540.0f, 50);
+        for (size_t i = 0; i < pool.count; i++) pool.drag[i] = dist01(gen) * 2.0f;
+    }
+
+    template <typename Kernel>
+    double Measure(SparkPool& pool, Kernel kernel) {
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < Frames; f++) {
+            kernel(pool, Dt, 0, pool.count, true);
+            pool.AdvanceTrail();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return (double)pool.count * Frames / elapsed.count();
+    }
+
+    // Largest relative difference; the compiler may fuse the scalar multiply-adds, so
+    // the paths can differ in the last bits
+    inline float MaxRelativeDifference(const SparkPool& a, const SparkPool& b) {
+        auto rel = [](float u, float v) { return fabsf(u - v) / std::max(1.0f, fabsf(u)); };
+        float diff = 0.0f;
+        for (size_t i = 0; i < a.count; i++) {
+            diff = std::max(diff, rel(a.x[i], b.x[i]));
+            diff = std::max(diff, rel(a.y[i], b.y[i]));
+            diff = std::max(diff, rel(a.vy[i], b.vy[i]));
+            diff = std::max(diff, rel(a.life[i], b.life[i]));
+        }
+        return diff;
+    }
+}
+
+inline int RunSparkBenchmark() {
+    using namespace SparkBenchmark;
+
+    SparkPool reference;
+    Fill(reference);
+    SparkPool vectorized = reference;
+
+    auto avx2 = [](SparkPool& p, float dt, size_t begin, size_t end, bool pushTrail) {
+        size_t done = IntegrateSparksAVX2(p, dt, begin, end, pushTrail);
+        IntegrateSparksScalar(p, dt, done, end, pushTrail);
+    };
+
+    printf("Spark integration: %zu sparks x %d frames\n", SparkCount, Frames);
+
+    double scalarRate = Measure(reference, IntegrateSparksScalar);
+    printf("  scalar : %8.1f M sparks/s\n", scalarRate / 1e6);
+
+    if (!CpuHasAVX2()) {
+        printf("  avx2   : not supported on this CPU\n");
+        return 0;
+    }
+
+    double avx2Rate = Measure(vectorized, avx2);
+    float diff = MaxRelativeDifference(reference, vectorized);
+    printf("  avx2   : %8.1f M sparks/s (%.2fx)\n", avx2Rate / 1e6, avx2Rate / scalarRate);
+    printf("  max relative difference = %g\n", diff);
+
+    // Ground collision against the same pool, as a share of integration cost. By now
+    // most sparks are at or below the floor, so nearly every group of eight takes the
+    // bounce: the worst case. No multiply-adds here, so both paths must agree exactly.
+    SparkGround ground;
+    ground.SetFloor(1000.0f);
+    SparkPool collideScalar = reference;
+    SparkPool collideAVX2 = reference;
+    CollideSparksScalar(collideScalar, ground, 0, collideScalar.count);
+    size_t done = CollideSparksAVX2(collideAVX2, ground, 0, collideAVX2.count);
+    CollideSparksScalar(collideAVX2, ground, done, collideAVX2.count);
+    float collideDiff = MaxRelativeDifference(collideScalar, collideAVX2);
+
+    auto collide = [&](SparkPool& p, float, size_t begin, size_t end, bool) {
+        size_t stop = CollideSparksAVX2(p, ground, begin, end);
+        CollideSparksScalar(p, ground, stop, end);
+    };
+    double collideRate = Measure(collideAVX2, collide);
+    printf("Ground collision (avx2)\n");
+    printf("  collide: %8.1f M sparks/s (%.0f%% of the integration cost)\n", collideRate / 1e6, 100.0 * avx2Rate / collideRate);
+    printf("  max relative difference = %g\n", collideDiff);
+
+    return (diff < 1e-3f && collideDiff == 0.0f) ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------
+// What sparks land on: the working-area floor, the taskbar top when TaskbarAware is
+// set and the bottom row of the screen otherwise. A flat floor makes the collision
+// test one compare per spark, eight at a time on the AVX2 path.
+//--------------------------------------------------------------------------------------
+struct SparkGround {
+    float floorY = 0.0f;
+
+    float bounce = 0.4f;          // vertical speed kept after hitting the ground
+    float friction = 0.7f;        // horizontal speed kept after hitting the ground
+    float burn = 0.3f;            // seconds of life each bounce costs
+    float restSpeed = 20.0f;      // slower bounces than this put the ember out
+
+    void SetFloor(float floor) { floorY = floor; }
+};
@@ -0,0 +1,142 @@
+#pragma once
+#include "Simd.h"
+#include "SparkPool.h"
+#include "SparkGround.h"
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Spark integration kernels over the SoA pool: trail push, drag, gravity, position and
+// life, all in seconds so sparks fly the same at any frame rate. Drag is a rate applied
+// implicitly (v / (1 + k dt)), which stays stable however long the frame. Each kernel
+// works on the range [begin, end) so callers can split the pool. The trail point is
+// only recorded when pushTrail is set, and the caller advances the shared trail head
+// once every range is done.
+//--------------------------------------------------------------------------------------
+
+// Scalar reference path, also used for the tail of the vector path
+inline void IntegrateSparksScalar(SparkPool& p, float dt, size_t begin, size_t end, bool pushTrail) {
+    const size_t plane = (size_t)p.trailHead * p.Capacity();
+
+    for (size_t i = begin; i < end; i++) {
+        if (pushTrail) {
+            p.trailX[plane + i] = p.x[i];
+            p.trailY[plane + i] = p.y[i];
+            if (p.trailCount[i] < SparkPool::TRAIL_MAX) p.trailCount[i]++;
+        }
+
+        float damp = 1.0f / (1.0f + p.drag[i] * dt);
+        float fall = p.gravity[i] * dt;
+        p.vx[i] = p.vx[i] * damp;
+        p.vy[i] = p.vy[i] * damp + fall;
+        p.x[i] += p.vx[i] * dt;
+        p.y[i] += p.vy[i] * dt;
+        p.life[i] -= dt;
+    }
+}
+
+// AVX2 path: eight sparks per iteration. Returns the index it stopped at.
+SIMD_TARGET_AVX2 inline size_t IntegrateSparksAVX2(SparkPool& p, float dt, size_t begin, size_t end, bool pushTrail) {
+    const size_t plane = (size_t)p.trailHead * p.Capacity();
+    const __m256 dtv = _mm256_set1_ps(dt);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m128i trailMax = _mm_set1_epi8(SparkPool::TRAIL_MAX);
+    const __m128i oneByte = _mm_set1_epi8(1);
+
+    float* x = p.x.data();
+    float* y = p.y.data();
+    float* vx = p.vx.data();
+    float* vy = p.vy.data();
+    float* life = p.life.data();
+    const float* drag = p.drag.data();
+    const float* gravity = p.gravity.data();
+    float* historyX = p.trailX.data() + plane;
+    float* historyY = p.trailY.data() + plane;
+    uint8_t* trailCount = p.trailCount.data();
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        if (pushTrail) {
+            _mm256_storeu_ps(historyX + i, px);
+            _mm256_storeu_ps(historyY + i, py);
+
+            // Saturating trail count bump for the same eight sparks
+            __m128i counts = _mm_loadl_epi64((const __m128i*)(trailCount + i));
+            _mm_storel_epi64((__m128i*)(trailCount + i), _mm_min_epu8(_mm_add_epi8(counts, oneByte), trailMax));
+        }
+
+        __m256 damp = _mm256_div_ps(one, _mm256_add_ps(one, _mm256_mul_ps(_mm256_loadu_ps(drag + i), dtv)));
+        __m256 fall = _mm256_mul_ps(_mm256_loadu_ps(gravity + i), dtv);
+        __m256 pvx = _mm256_mul_ps(_mm256_loadu_ps(vx + i), damp);
+        __m256 pvy = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vy + i), damp), fall);
+        _mm256_storeu_ps(vx + i, pvx);
+        _mm256_storeu_ps(vy + i, pvy);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(px, _mm256_mul_ps(pvx, dtv)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(py, _mm256_mul_ps(pvy, dtv)));
+        _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), dtv));
+    }
+    return i;
+}
+
+inline void IntegrateSparks(SparkPool& p, float dt, size_t begin, size_t end, bool pushTrail) {
+    size_t done = CpuHasAVX2() ? IntegrateSparksAVX2(p, dt, begin, end, pushTrail) : begin;
+    IntegrateSparksScalar(p, dt, done, end, pushTrail);
+}
+
+//--------------------------------------------------------------------------------------
+// Ground collision: sparks moving down through the floor are put back on it and
+// bounce, losing speed and life; an ember that bounces too slowly goes out. Run after
+// integration over the same range.
+//--------------------------------------------------------------------------------------
+inline void CollideSparksScalar(SparkPool& p, const SparkGround& g, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (!(p.y[i] >= g.floorY && p.vy[i] > 0.0f)) continue;
+
+        p.y[i] = g.floorY;
+        p.vy[i] = p.vy[i] * -g.bounce;
+        p.vx[i] = p.vx[i] * g.friction;
+        p.life[i] -= g.burn;
+        if (p.vy[i] > -g.restSpeed) p.life[i] = 0.0f;
+    }
+}
+
+// AVX2 path: eight sparks cost two compares, and nothing more unless one of them hit.
+// Returns the index it stopped at.
+SIMD_TARGET_AVX2 inline size_t CollideSparksAVX2(SparkPool& p, const SparkGround& g, size_t begin, size_t end) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 ground = _mm256_set1_ps(g.floorY);
+    const __m256 bounce = _mm256_set1_ps(-g.bounce);
+    const __m256 friction = _mm256_set1_ps(g.friction);
+    const __m256 burn = _mm256_set1_ps(g.burn);
+    const __m256 rest = _mm256_set1_ps(-g.restSpeed);
+
+    float* y = p.y.data();
+    float* vx = p.vx.data();
+    float* vy = p.vy.data();
+    float* life = p.life.data();
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 pvy = _mm256_loadu_ps(vy + i);
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(py, ground, _CMP_GE_OQ), _mm256_cmp_ps(pvy, zero, _CMP_GT_OQ));
+        if (_mm256_movemask_ps(hit) == 0) continue;
+
+        __m256 nvy = _mm256_mul_ps(pvy, bounce);
+        __m256 nlife = _mm256_sub_ps(_mm256_loadu_ps(life + i), burn);
+        nlife = _mm256_blendv_ps(nlife, zero, _mm256_cmp_ps(nvy, rest, _CMP_GT_OQ));
+
+        __m256 pvx = _mm256_loadu_ps(vx + i);
+        _mm256_storeu_ps(y + i, _mm256_blendv_ps(py, ground, hit));
+        _mm256_storeu_ps(vy + i, _mm256_blendv_ps(pvy, nvy, hit));
+        _mm256_storeu_ps(vx + i, _mm256_blendv_ps(pvx, _mm256_mul_ps(pvx, friction), hit));
+        _mm256_storeu_ps(life + i, _mm256_blendv_ps(_mm256_loadu_ps(life + i), nlife, hit));
+    }
+    return i;
+}
+
+inline void CollideSparks(SparkPool& p, const SparkGround& g, size_t begin, size_t end) {
+    size_t done = CpuHasAVX2() ? CollideSparksAVX2(p, g, begin, end) : begin;
+    CollideSparksScalar(p, g, done, end);
+}
@@ -0,0 +1,267 @@
+#pragma once
+#include "raylib_win32.h"
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+extern std::mt19937 gen;
+extern std::uniform_real_distribution<float> dist01;
+
+// ======================================================
+// SparkPool
+// ======================================================
+// Every live spark in the simulation, stored as structure-of-arrays with a fixed
+// capacity chosen up front. Sparks are addressed by index: an explosion claims a
+// block of slots, the update is one flat sweep over contiguous arrays, and dead
+// sparks are retired in bulk by compacting the survivors. Nothing allocates after
+// Reserve().
+//
+// Every spark records a trail point at the same moments (TRAIL_INTERVAL apart, so a
+// trail spans the same time at any frame rate), so the trail history is one shared
+// ring of TRAIL_MAX planes with a single head: plane h holds every spark's position
+// from the same moment, and a spark only tracks how many of the newest planes belong
+// to it.
+//
+// Level of detail follows remaining life: a spark draws its full trail, then half of
+// it, then only its core as it burns out, and is culled once it is nearly invisible.
+// When more sparks are alive than the threshold, every life threshold and the trail
+// interval stretch in proportion (up to LOD_MAX_SCALE), so a busy sky drops detail
+// sooner and records trail points less often. Physics still steps every live spark on
+// every update; only drawing, trail recording and culling scale back.
+struct SparkPool {
+    static constexpr int TRAIL_MAX = 10; // shorter trail for performance
+    static constexpr float TRAIL_INTERVAL = 1.0f / 60.0f; // seconds between trail points
+    static constexpr float LOD_MAX_SCALE = 4.0f;
+
+    enum LodTier { LodFull, LodReduced, LodMinimal, LodTierCount };
+
+    struct LodSettings {
+        float reducedLife = 0.6f;     // below this a spark draws half its trail
+        float minimalLife = 0.25f;    // below this only the core is drawn
+        float cullLife = 0.08f;       // below this the spark is retired
+        size_t sparkThreshold = 8192; // live sparks before the thresholds stretch
+    };
+
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;    // pixels per second
+    std::vector<float> life;      // seconds
+    std::vector<float> drag;      // velocity decay rate per second
+    std::vector<float> gravity;   // downward acceleration, pixels per second squared
+    std::vector<float> fuse;      // seconds until a crossette splits, 0 = never
+    std::vector<Color> color;
+
+    // Shared trail history: point k of spark i is at [k * Capacity() + i]
+    std::vector<float> trailX, trailY;
+    std::vector<uint8_t> trailCount;
+    int trailHead = 0; // plane the next trail point goes to
+    float trailClock = 0.0f;
+
+    size_t count = 0;
+    size_t pendingSplits = 0;     // sparks with a lit fuse
+
+    LodSettings lod;
+    float lodScale = 1.0f;        // stretch on the tier and cull lives and the trail interval
+
+    void Reserve(size_t capacity) {
+        x.resize(capacity); y.resize(capacity);
+        vx.resize(capacity); vy.resize(capacity);
+        life.resize(capacity);
+        drag.resize(capacity);
+        gravity.resize(capacity);
+        fuse.resize(capacity);
+        color.resize(capacity);
+        trailX.resize(capacity * TRAIL_MAX);
+        trailY.resize(capacity * TRAIL_MAX);
+        trailCount.resize(capacity);
+    }
+
+    size_t Capacity() const { return x.size(); }
+    size_t Free() const { return Capacity() - count; }
+
+    // Claims up to n slots at the end of the live range; returns how many were claimed
+    size_t Allocate(size_t n, size_t& first) {
+        if (n > Free()) n = Free();
+        first = count;
+        count += n;
+        return n;
+    }
+
+    // Bursts up to n sparks at (sx, sy) in random directions
+    void Emit(float sx, float sy, int n) {
+        size_t first;
+        size_t claimed = Allocate((size_t)n, first);
+        FillRandom(first, claimed, sx, sy, gen);
+    }
+
+    // Random burst into slots already claimed with Allocate(); safe to run for
+    // disjoint ranges on several threads, each with its own rng
+    void FillRandom(size_t first, size_t n, float sx, float sy, std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (size_t i = first; i < first + n; i++) {
+            float angle = unit(rng) * 2.0f * PI;
+            float speed = unit(rng) * 240.0f + 60.0f;
+            x[i] = sx; y[i] = sy;
+            vx[i] = cosf(angle) * speed;
+            vy[i] = sinf(angle) * speed;
+            life[i] = unit(rng) * 1.0f + 1.0f;
+            drag[i] = 0.0f;
+            gravity[i] = 90.0f;
+            fuse[i] = 0.0f;
+            color[i] = {
+                (unsigned char)(unit(rng) * 255),
+                (unsigned char)(unit(rng) * 255),
+                (unsigned char)(unit(rng) * 255),
+                255
+            };
+            trailCount[i] = 0;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Burns crossette fuses; a spark whose fuse runs out dies and throws four children
+    // diagonally off its path. Only walks the pool while some fuse is still lit.
+    //--------------------------------------------------------------------------------------
+    void BurnFuses(float dt) {
+        if (pendingSplits == 0) return;
+
+        const size_t end = count;
+        for (size_t i = 0; i < end; i++) {
+            if (fuse[i] <= 0.0f) continue;
+            fuse[i] -= dt;
+            if (fuse[i] > 0.0f) continue;
+
+            fuse[i] = 0.0f;
+            pendingSplits--;
+
+            size_t first;
+            size_t claimed = Allocate(4, first);
+            float speed = sqrtf(vx[i] * vx[i] + vy[i] * vy[i]) * 0.8f;
+            float heading = atan2f(vy[i], vx[i]);
+            for (size_t c = 0; c < claimed; c++) {
+                size_t k = first + c;
+                float angle = heading + PI * 0.25f + c * PI * 0.5f;
+                x[k] = x[i]; y[k] = y[i];
+                vx[k] = cosf(angle) * speed;
+                vy[k] = sinf(angle) * speed;
+                life[k] = life[i];
+                drag[k] = drag[i];
+                gravity[k] = gravity[i];
+                fuse[k] = 0.0f;
+                color[k] = color[i];
+                trailCount[k] = 0;
+            }
+            life[i] = 0.0f;
+        }
+    }
+
+    // Recomputes the load factor from the live count; call once per update
+    void UpdateLod() {
+        lodScale = std::clamp((float)count / (float)std::max<size_t>(lod.sparkThreshold, 1), 1.0f, LOD_MAX_SCALE);
+    }
+
+    LodTier Tier(float lifeLeft) const {
+        if (lifeLeft > lod.reducedLife * lodScale) return LodFull;
+        if (lifeLeft > lod.minimalLife * lodScale) return LodReduced;
+        return LodMinimal;
+    }
+
+    static int TrailLimit(LodTier tier) {
+        return tier == LodFull ? TRAIL_MAX : tier == LodReduced ? TRAIL_MAX / 2 : 0;
+    }
+
+    float CullLife() const { return lod.cullLife * lodScale; }
+
+    // True when this update should record a trail point; at most one per update
+    bool TrailDue(float dt) {
+        const float interval = TRAIL_INTERVAL * lodScale;
+        trailClock += dt;
+        if (trailClock < interval) return false;
+        trailClock = fmodf(trailClock, interval);
+        return true;
+    }
+
+    // Called after every spark has pushed its trail point
+    void AdvanceTrail() {
+        trailHead = (trailHead + 1) % TRAIL_MAX;
+    }
+
+    // Bulk retirement: one pass that packs live sparks to the front. Everything before
+    // `from` is known to be alive.
+    void Retire(size_t from = 0) {
+        size_t kept = from;
+        for (size_t i = from; i < count; i++) {
+            if (life[i] <= 0.0f) {
+                if (fuse[i] > 0.0f) pendingSplits--; // burnt out before splitting
+                continue;
+            }
+            if (kept != i) Move(kept, i);
+            kept++;
+        }
+        count = kept;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Emits every trail as line segments with per-vertex alpha, then every core as a
+    // quad. Both go into whatever rlgl batch is active, so the caller decides how many
+    // draw calls the layer takes.
+    //--------------------------------------------------------------------------------------
+    void Draw() const {
+        const size_t cap = Capacity();
+
+        // Plane holding the point recorded `age` updates ago (0 = newest)
+        size_t plane[TRAIL_MAX];
+        for (int age = 0; age < TRAIL_MAX; age++)
+            plane[age] = (size_t)((trailHead - 1 - age + 2 * TRAIL_MAX) % TRAIL_MAX) * cap;
+
+        rlBegin(RL_LINES);
+        for (size_t s = 0; s < count; s++) {
+            int n = std::min((int)trailCount[s], TrailLimit(Tier(life[s])));
+            if (n == 0) continue;
+
+            // Oldest point fades in from zero, the live position ends at 180
+            const Color c = color[s];
+            float prevX = trailX[plane[n - 1] + s];
+            float prevY = trailY[plane[n - 1] + s];
+            unsigned char prevA = 0;
+            for (int k = 1; k <= n; k++) {
+                float px = (k == n) ? x[s] : trailX[plane[n - 1 - k] + s];
+                float py = (k == n) ? y[s] : trailY[plane[n - 1 - k] + s];
+                unsigned char a = (unsigned char)(k * 180 / n);
+
+                rlColor4ub(c.r, c.g, c.b, prevA); rlVertex2f(prevX, prevY);
+                rlColor4ub(c.r, c.g, c.b, a);     rlVertex2f(px, py);
+                prevX = px; prevY = py; prevA = a;
+            }
+        }
+        rlEnd();
+
+        // Core spark
+        rlBegin(RL_QUADS);
+        for (size_t s = 0; s < count; s++) {
+            float cx = floorf(x[s]), cy = floorf(y[s]);
+            rlColor4ub(255, 255, 255, (unsigned char)(Clamp(life[s] * 255, 0.0f, 255.0f)));
+            rlVertex2f(cx - 2, cy - 2);
+            rlVertex2f(cx - 2, cy + 2);
+            rlVertex2f(cx + 2, cy + 2);
+            rlVertex2f(cx + 2, cy - 2);
+        }
+        rlEnd();
+    }
+
+private:
+    void Move(size_t dst, size_t src) {
+        x[dst] = x[src]; y[dst] = y[src];
+        vx[dst] = vx[src]; vy[dst] = vy[src];
+        life[dst] = life[src];
+        drag[dst] = drag[src];
+        gravity[dst] = gravity[src];
+        fuse[dst] = fuse[src];
+        color[dst] = color[src];
+        for (size_t k = 0, cap = Capacity(); k < TRAIL_MAX; k++) {
+            trailX[k * cap + dst] = trailX[k * cap + src];
+            trailY[k * cap + dst] = trailY[k * cap + src];
+        }
+        trailCount[dst] = trailCount[src];
+    }
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+//--------------------------------------------------------------------------------------
+// Fixed-size ring for one producer thread and one consumer thread, without locks.
+//
+// Each side owns one index and only reads the other's. The producer writes the item
+// and then publishes its new head with a release store; the consumer's acquire load of
+// the head makes the item visible before it reads it, and the same holds the other way
+// for freed slots. The indices sit on their own cache lines so the two threads don't
+// keep taking the line from each other. Capacity must be a power of two, and one slot
+// stays empty to tell a full ring from an empty one.
+//--------------------------------------------------------------------------------------
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer side. Returns false (and drops the item) when the ring is full.
+    bool Push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t next = (h + 1) & (Capacity - 1);
+        if (next == tail.load(std::memory_order_acquire)) return false;
+        items[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool Pop(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = items[t];
+        tail.store((t + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head{ 0 }; // next slot to write, owned by the producer
+    alignas(64) std::atomic<size_t> tail{ 0 }; // next slot to read, owned by the consumer
+    alignas(64) T items[Capacity];
+};
@@ -0,0 +1,328 @@
+#pragma once
+#include "raylib_win32.h"
+#include "StrokeMesh.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+struct Stroke {
+    std::vector<Vector2> points;
+    Color color;
+    int brushSize;
+    bool highlighter;
+    uint32_t id = 0; // runtime handle (see StrokeIndex.h), not saved
+};
+
+// ======================================================
+// Stroke document
+// ======================================================
+// Drawings are saved as a small binary file:
+//
+//     header   "DSTK", u16 version, u16 reserved            (little endian)
+//     record*  u8 type, varint payload length, payload
+//
+//     style    (type 1)  r g b a, varint brush size, u8 flags (1 = highlighter)
+//     stroke   (type 2)  varint style, varint point count,
+//                        first point, then one delta per further point
+//
+// Styles are numbered in the order they appear, and a stroke refers to an earlier
+// one. Points are world coordinates in quarter pixels, clamped to +-2^28 so a delta
+// always fits, and each coordinate is a zigzag varint. Kept stroke points are a few
+// pixels apart, so most deltas take one byte. Files from before the canvas could pan
+// only hold small coordinates and read the same way.
+//
+// A finished stroke is appended as one record. A file cut off mid-record (crash,
+// full disk) loads up to the last whole record. Records of unknown type are skipped
+// by length, so later versions can add them without breaking older readers.
+// Everything read is bounds checked, and counts are capped by the bytes left, so a
+// corrupt file can't make the reader allocate more than its own size. StrokeFuzz.h
+// (--fuzz-doc) feeds the reader damaged files to back that up.
+namespace StrokeFormat {
+    constexpr char Magic[4] = { 'D', 'S', 'T', 'K' };
+    constexpr uint16_t Version = 1;
+    constexpr size_t HeaderSize = 8;
+    constexpr float Scale = 4.0f; // units per pixel
+    constexpr int32_t MaxUnits = 1 << 28;
+
+    enum RecordType : uint8_t { RecordStyle = 1, RecordStroke = 2 };
+
+    struct Style {
+        Color color;
+        int brushSize;
+        bool highlighter;
+
+        bool operator==(const Style& o) const {
+            return color.r == o.color.r && color.g == o.color.g && color.b == o.color.b && color.a == o.color.a
+                && brushSize == o.brushSize && highlighter == o.highlighter;
+        }
+    };
+
+    inline Style StyleOf(const Stroke& s) { return { s.color, s.brushSize, s.highlighter }; }
+
+    //--------------------------------------------------------------------------------------
+    // Encoding
+    //--------------------------------------------------------------------------------------
+    inline void PutVarint(std::vector<uint8_t>& out, uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+    inline uint32_t Zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    inline int32_t Unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    inline int32_t Quantize(float v) {
+        return (int32_t)std::clamp(llrintf(v * Scale), -(long long)MaxUnits, (long long)MaxUnits);
+    }
+
+    inline void PutHeader(std::vector<uint8_t>& out) {
+        out.insert(out.end(), Magic, Magic + 4);
+        out.push_back(Version & 0xff);
+        out.push_back(Version >> 8);
+        out.push_back(0);
+        out.push_back(0);
+    }
+
+    inline void PutRecord(std::vector<uint8_t>& out, RecordType type, const std::vector<uint8_t>& payload) {
+        out.push_back(type);
+        PutVarint(out, (uint32_t)payload.size());
+        out.insert(out.end(), payload.begin(), payload.end());
+    }
+
+    // Appends the stroke, plus a style record first if its style is new to `styles`
+    inline void PutStroke(std::vector<uint8_t>& out, std::vector<Style>& styles, const Stroke& stroke, std::vector<uint8_t>& payload) {
+        if (stroke.points.empty()) return;
+        Style style = StyleOf(stroke);
+        size_t index = std::find(styles.begin(), styles.end(), style) - styles.begin();
+        if (index == styles.size()) {
+            styles.push_back(style);
+            payload.clear();
+            payload.insert(payload.end(), { style.color.r, style.color.g, style.color.b, style.color.a });
+            PutVarint(payload, (uint32_t)std::max(style.brushSize, 0));
+            payload.push_back(style.highlighter ? 1 : 0);
+            PutRecord(out, RecordStyle, payload);
+        }
+
+        payload.clear();
+        PutVarint(payload, (uint32_t)index);
+        PutVarint(payload, (uint32_t)stroke.points.size());
+        int32_t px = 0, py = 0;
+        for (const Vector2& p : stroke.points) {
+            int32_t x = Quantize(p.x), y = Quantize(p.y);
+            PutVarint(payload, Zigzag(x - px));
+            PutVarint(payload, Zigzag(y - py));
+            px = x; py = y;
+        }
+        PutRecord(out, RecordStroke, payload);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Decoding
+    //--------------------------------------------------------------------------------------
+    struct Reader {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool ok = true;
+
+        size_t Left() const { return (size_t)(end - p); }
+
+        uint8_t Byte() {
+            if (p >= end) { ok = false; return 0; }
+            return *p++;
+        }
+
+        uint32_t Varint() {
+            uint32_t v = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                uint8_t b = Byte();
+                if (!ok) return 0;
+                v |= (uint32_t)(b & 0x7f) << shift;
+                if (!(b & 0x80)) return v;
+            }
+            ok = false; // more than five bytes
+            return 0;
+        }
+    };
+
+    // Reads every whole, valid record into `strokes` and `styles`. Returns false when the
+    // data isn't a document this version understands; trailing damage just ends the read.
+    inline bool Decode(const uint8_t* data, size_t size, std::vector<Stroke>& strokes, std::vector<Style>& styles) {
+        strokes.clear();
+        styles.clear();
+        if (size < HeaderSize || memcmp(data, Magic, 4) != 0) return false;
+        uint16_t version = (uint16_t)(data[4] | data[5] << 8);
+        if (version == 0 || version > Version) return false;
+
+        Reader file{ data + HeaderSize, data + size };
+        while (file.Left() > 0) {
+            uint8_t type = file.Byte();
+            uint32_t length = file.Varint();
+            if (!file.ok || length > file.Left()) break;
+
+            Reader rec{ file.p, file.p + length };
+            file.p += length;
+
+            if (type == RecordStyle) {
+                Style style;
+                style.color = { rec.Byte(), rec.Byte(), rec.Byte(), rec.Byte() };
+                style.brushSize = (int)std::min<uint32_t>(rec.Varint(), 4096);
+                style.highlighter = (rec.Byte() & 1) != 0;
+                if (!rec.ok) break;
+                styles.push_back(style);
+            }
+            else if (type == RecordStroke) {
+                uint32_t index = rec.Varint();
+                uint32_t count = rec.Varint();
+                // Each point takes at least two bytes
+                if (!rec.ok || index >= styles.size() || count == 0 || count > rec.Left() / 2) break;
+
+                Stroke stroke;
+                const Style& style = styles[index];
+                stroke.color = style.color;
+                stroke.brushSize = style.brushSize;
+                stroke.highlighter = style.highlighter;
+                stroke.points.resize(count);
+
+                // Summed wide so crafted deltas can't overflow; the writer never goes
+                // past MaxUnits, so a point beyond it means the record is damaged
+                int64_t x = 0, y = 0;
+                for (uint32_t i = 0; i < count && rec.ok; i++) {
+                    x += Unzigzag(rec.Varint());
+                    y += Unzigzag(rec.Varint());
+                    if (x < -MaxUnits || x > MaxUnits || y < -MaxUnits || y > MaxUnits) rec.ok = false;
+                    stroke.points[i] = { (float)x / Scale, (float)y / Scale };
+                }
+                if (!rec.ok) break;
+                strokes.push_back(std::move(stroke));
+            }
+            // Anything else is a record from a later version
+        }
+        return true;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Writes the document as strokes finish. Rewrite() replaces the whole file (after undo,
+// redo or a clear) and leaves it open, and Append() adds one finished stroke and
+// flushes, so at most the stroke being drawn is lost if the process dies.
+//--------------------------------------------------------------------------------------
+class StrokeDocumentWriter {
+public:
+    bool Rewrite(const std::string& path, const std::vector<Stroke>& strokes) {
+        Close();
+        this->path = path;
+        styles.clear();
+
+        buffer.clear();
+        StrokeFormat::PutHeader(buffer);
+        for (const Stroke& s : strokes)
+            StrokeFormat::PutStroke(buffer, styles, s, payload);
+
+        // Written beside the old file and swapped in, so a failed write never loses it
+        std::filesystem::path temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            out.write((const char*)buffer.data(), (std::streamsize)buffer.size());
+            if (!out) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) return false;
+
+        file.open(path, std::ios::binary | std::ios::app);
+        return file.is_open();
+    }
+
+    void Append(const Stroke& stroke) {
+        if (!file.is_open()) return;
+        buffer.clear();
+        StrokeFormat::PutStroke(buffer, styles, stroke, payload);
+        file.write((const char*)buffer.data(), (std::streamsize)buffer.size());
+        file.flush();
+    }
+
+    void Close() {
+        if (file.is_open()) file.close();
+    }
+
+    bool IsOpen() const { return file.is_open(); }
+
+private:
+    std::string path;
+    std::ofstream file;
+    std::vector<StrokeFormat::Style> styles;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> payload;
+};
+
+//--------------------------------------------------------------------------------------
+// Reads a document on a worker thread and builds its stroke geometry there too, so the
+// main thread only has to draw the finished meshes into the canvas. The build function
+// gets one mesh for ink and one for the highlighter layer.
+//--------------------------------------------------------------------------------------
+class StrokeDocumentLoader {
+public:
+    using BuildFn = std::function<void(const std::vector<Stroke>&, StrokeMesh& ink, StrokeMesh& highlights)>;
+
+    ~StrokeDocumentLoader() {
+        if (worker.joinable()) worker.join();
+    }
+
+    void Start(const std::string& path, BuildFn build) {
+        if (worker.joinable()) worker.join();
+        finished = false;
+        running = true;
+        worker = std::thread([this, path, build] {
+            std::vector<uint8_t> data;
+            std::ifstream in(path, std::ios::binary);
+            if (in.is_open())
+                data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+            // A missing or empty file is a new document; anything else must decode
+            std::vector<StrokeFormat::Style> styles;
+            writable = StrokeFormat::Decode(data.data(), data.size(), strokes, styles) || data.empty();
+            ink.Clear();
+            highlights.Clear();
+            build(strokes, ink, highlights);
+            finished.store(true, std::memory_order_release);
+        });
+    }
+
+    bool Busy() const { return running; }
+
+    // False when the file exists but isn't a document this version can read, in which
+    // case it must not be overwritten
+    bool Writable() const { return writable; }
+
+    // Hands over the loaded strokes and their meshes once the worker is done
+    bool Take(std::vector<Stroke>& out, StrokeMesh& outInk, StrokeMesh& outHighlights) {
+        if (!running || !finished.load(std::memory_order_acquire)) return false;
+        worker.join();
+        running = false;
+        out = std::move(strokes);
+        std::swap(outInk, ink);
+        std::swap(outHighlights, highlights);
+        strokes.clear();
+        return true;
+    }
+
+private:
+    std::thread worker;
+    std::atomic<bool> finished{ false };
+    bool running = false;
+    bool writable = false;
+    std::vector<Stroke> strokes;
+    StrokeMesh ink;
+    StrokeMesh highlights;
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include "StrokeRaster.h"
+#include "Config.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+extern ConfigManager configManager;
+
+// ======================================================
+// Stroke document export (--export <document> <image>)
+// ======================================================
+// Renders a saved drawing with the software rasterizer and writes it out with
+// ExportImage (PNG by extension). The image spans from the world origin (the screen's
+// top-left corner before any panning) out to the furthest stroke in each direction,
+// so strokes drawn left of or above it are kept too. As on screen, highlighter strokes
+// are drawn opaque into their own layer, which goes under the ink at the configured
+// highlighter alpha.
+
+constexpr int MaxExportSize = 8192; // per side; at that size the two rasters already take about 1 GB
+
+inline int RunStrokeExport(const char* documentPath, const char* imagePath) {
+    std::ifstream in(documentPath, std::ios::binary);
+    if (!in.is_open()) {
+        printf("Can't open %s\n", documentPath);
+        return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::vector<Stroke> strokes;
+    std::vector<StrokeFormat::Style> styles;
+    if (!StrokeFormat::Decode(data.data(), data.size(), strokes, styles)) {
+        printf("%s is not a stroke document this version can read\n", documentPath);
+        return 1;
+    }
+
+    float left = 0.0f, top = 0.0f, right = 1.0f, bottom = 1.0f;
+    for (const Stroke& s : strokes) {
+        for (const Vector2& p : s.points) {
+            left = std::min(left, p.x - s.brushSize - 1.0f);
+            top = std::min(top, p.y - s.brushSize - 1.0f);
+            right = std::max(right, p.x + s.brushSize + 1.0f);
+            bottom = std::max(bottom, p.y + s.brushSize + 1.0f);
+        }
+    }
+    left = floorf(left);
+    top = floorf(top);
+    if (right - left > MaxExportSize || bottom - top > MaxExportSize) {
+        printf("%s spans %.0fx%.0f px, more than the %d px export limit\n", documentPath, right - left, bottom - top, MaxExportSize);
+        return 1;
+    }
+
+    // The raster starts at (0, 0), so the drawing is moved there
+    for (Stroke& s : strokes) {
+        for (Vector2& p : s.points) {
+            p.x -= left;
+            p.y -= top;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    StrokeRaster raster, highlights;
+    raster.Resize((int)ceilf(right - left), (int)ceilf(bottom - top));
+    highlights.Resize(raster.Width(), raster.Height());
+    highlights.SetLayerBlend(true);
+    for (const Stroke& s : strokes)
+        if (s.highlighter) highlights.DrawStroke(s, { s.color.r, s.color.g, s.color.b, 255 });
+    raster.DrawLayer(highlights, configManager.GetConfig()->DrawingSimConfig.highlighterAlpha);
+    for (const Stroke& s : strokes)
+        if (!s.highlighter) raster.DrawStroke(s, s.color);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    bool written = raster.Export(imagePath);
+    printf("%zu strokes, %dx%d, rasterized in %.1f ms (%s) -> %s %s\n", strokes.size(), raster.Width(), raster.Height(),
+        elapsed.count(), CpuHasAVX2() ? "AVX2" : "scalar", imagePath, written ? "ok" : "FAILED");
+    return written ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "raylib_win32.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Streaming point filter for strokes.
+//
+// Mouse samples arrive every frame whether the cursor moved or not. Samples closer than
+// half a pixel to the previous one are dropped. The rest go through an online
+// Ramer-Douglas-Peucker pass: samples since the last kept point are buffered for as
+// long as a straight line from that point to the newest sample stays within
+// `tolerance` of all of them. When one strays further, the sample before the newest is
+// kept and becomes the next anchor. Only kept points are stored in the stroke, so a
+// straight drag costs one point per MaxPending samples instead of one per frame.
+//
+// Kept points are rendered through SmoothStroke(), which puts a centripetal
+// Catmull-Rom curve through them. The curve stays smooth where decimation left points
+// far apart, and it doesn't loop or overshoot at uneven spacing.
+//--------------------------------------------------------------------------------------
+class StrokeFilter {
+public:
+    static constexpr float MinMove = 0.5f;  // samples closer than this to the last one are repeats
+    static constexpr size_t MaxPending = 128; // keeps each test bounded on very long straight drags
+
+    // Starts a stroke at p, which is always kept
+    void Begin(std::vector<Vector2>& points, Vector2 p, float tolerance) {
+        this->tolerance = std::max(tolerance, 0.0f);
+        pending.clear();
+        points.push_back(p);
+        last = p;
+        raw = 1;
+    }
+
+    // Returns true when the sample made an earlier one a kept point
+    bool Add(std::vector<Vector2>& points, Vector2 p) {
+        float dx = p.x - last.x, dy = p.y - last.y;
+        if (dx * dx + dy * dy < MinMove * MinMove) return false;
+        last = p;
+        raw++;
+
+        bool kept = false;
+        if (!pending.empty() && (pending.size() >= MaxPending || !Fits(points.back(), p))) {
+            points.push_back(pending.back());
+            pending.clear();
+            kept = true;
+        }
+        pending.push_back(p);
+        return kept;
+    }
+
+    // Keeps the final sample so the stroke ends where the cursor stopped
+    void End(std::vector<Vector2>& points) {
+        if (!pending.empty()) points.push_back(pending.back());
+        pending.clear();
+    }
+
+    // Newest sample, which is where the live end of the stroke is drawn to
+    Vector2 Last() const { return last; }
+    bool HasPending() const { return !pending.empty(); }
+    size_t RawSamples() const { return raw; }
+
+private:
+    // Every buffered sample lies within tolerance of the segment anchor -> p
+    bool Fits(Vector2 anchor, Vector2 p) const {
+        float dx = p.x - anchor.x, dy = p.y - anchor.y;
+        float len2 = dx * dx + dy * dy;
+        float tol2 = tolerance * tolerance;
+        for (const Vector2& q : pending) {
+            float qx = q.x - anchor.x, qy = q.y - anchor.y;
+            float t = len2 > 0.0f ? std::clamp((qx * dx + qy * dy) / len2, 0.0f, 1.0f) : 0.0f;
+            float ex = qx - dx * t, ey = qy - dy * t;
+            if (ex * ex + ey * ey > tol2) return false;
+        }
+        return true;
+    }
+
+    std::vector<Vector2> pending;  // samples since the last kept point
+    Vector2 last = { 0, 0 };
+    float tolerance = 1.0f;
+    size_t raw = 0;
+};
+
+//--------------------------------------------------------------------------------------
+// Catmull-Rom resampling
+//--------------------------------------------------------------------------------------
+namespace StrokeSpline {
+    // Missing neighbours at the ends are mirrored, so the curve leaves and enters the
+    // end points in a straight line
+    inline Vector2 At(const Vector2* pts, size_t count, long long i) {
+        if (i < 0) return { 2 * pts[0].x - pts[1].x, 2 * pts[0].y - pts[1].y };
+        if (i >= (long long)count) return { 2 * pts[count - 1].x - pts[count - 2].x, 2 * pts[count - 1].y - pts[count - 2].y };
+        return pts[i];
+    }
+
+    inline float Knot(Vector2 a, Vector2 b) {
+        float dx = b.x - a.x, dy = b.y - a.y;
+        return std::max(sqrtf(sqrtf(dx * dx + dy * dy)), 1e-3f); // |b - a| ^ 0.5
+    }
+
+    inline Vector2 Lerp(Vector2 a, Vector2 b, float ta, float tb, float t) {
+        float u = (t - ta) / (tb - ta);
+        return { a.x + (b.x - a.x) * u, a.y + (b.y - a.y) * u };
+    }
+
+    // Angle between the directions a -> b and b -> c
+    inline float Turn(Vector2 a, Vector2 b, Vector2 c) {
+        float ux = b.x - a.x, uy = b.y - a.y, vx = c.x - b.x, vy = c.y - b.y;
+        float lu = sqrtf(ux * ux + uy * uy), lv = sqrtf(vx * vx + vy * vy);
+        if (lu < 1e-3f || lv < 1e-3f) return 0.0f;
+        return acosf(std::clamp((ux * vx + uy * vy) / (lu * lv), -1.0f, 1.0f));
+    }
+}
+
+// Writes the smoothed polyline for the segments ending at pts[first..last] into out,
+// starting at pts[first - 1] (or pts[0] when first == 0). Long segments that bend are
+// cut into more pieces; straight ones stay a single piece.
+inline void SmoothStroke(const Vector2* pts, size_t count, size_t first, size_t last, std::vector<Vector2>& out) {
+    using namespace StrokeSpline;
+    out.clear();
+    if (count == 0) return;
+    last = std::min(last, count - 1);
+    out.push_back(pts[first == 0 ? 0 : std::min(first - 1, last)]);
+
+    for (size_t i = std::max<size_t>(first, 1); i <= last; i++) {
+        Vector2 p0 = At(pts, count, (long long)i - 2), p1 = pts[i - 1], p2 = pts[i], p3 = At(pts, count, (long long)i + 1);
+
+        float dx = p2.x - p1.x, dy = p2.y - p1.y;
+        float len = sqrtf(dx * dx + dy * dy);
+        float bend = Turn(p0, p1, p2) + Turn(p1, p2, p3);
+        int pieces = std::clamp((int)ceilf(sqrtf(len * bend)), 1, 24);
+
+        float t0 = 0.0f;
+        float t1 = t0 + Knot(p0, p1);
+        float t2 = t1 + Knot(p1, p2);
+        float t3 = t2 + Knot(p2, p3);
+        for (int k = 1; k < pieces; k++) {
+            float t = t1 + (t2 - t1) * k / pieces;
+            Vector2 a1 = Lerp(p0, p1, t0, t1, t), a2 = Lerp(p1, p2, t1, t2, t), a3 = Lerp(p2, p3, t2, t3, t);
+            Vector2 b1 = Lerp(a1, a2, t0, t2, t), b2 = Lerp(a2, a3, t1, t3, t);
+            out.push_back(Lerp(b1, b2, t1, t2, t));
+        }
+        out.push_back(p2);
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "StrokeDocument.h"
+#include <cstdio>
+#include <cmath>
+#include <random>
+
+// ======================================================
+// Stroke document reader check (--fuzz-doc)
+// ======================================================
+// Feeds StrokeFormat::Decode damaged copies of a sample document and checks what the
+// header of StrokeDocument.h promises: no point outside the writer's range, nothing
+// allocated past the file's own size, and a cut-off file loading up to its last whole
+// record. Memory errors only show up as crashes here, so run it from a build with the
+// address sanitizer (/fsanitize=address) turned on to catch them reliably.
+
+namespace StrokeFuzz {
+    constexpr int SampleStrokes = 20;
+    constexpr int Iterations = 200000;
+    constexpr float MaxCoordinate = StrokeFormat::MaxUnits / StrokeFormat::Scale;
+
+    inline std::vector<Stroke> MakeSample(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<Stroke> strokes;
+        for (int i = 0; i < SampleStrokes; i++) {
+            Stroke s;
+            s.color = { (unsigned char)(rng() % 4 * 60), 100, 200, 255 };
+            s.brushSize = 1 + (int)(rng() % 3) * 5;
+            s.highlighter = rng() % 5 == 0;
+            // A few strokes sit far out on the panned canvas, next to the clamp
+            float range = i % 5 == 0 ? MaxCoordinate * 0.9f : 2000.0f;
+            float x = (unit(rng) * 2.0f - 1.0f) * range;
+            float y = (unit(rng) * 2.0f - 1.0f) * range;
+            int points = 10 + (int)(rng() % 40);
+            for (int k = 0; k < points; k++) {
+                x += unit(rng) * 8.0f - 4.0f;
+                y += unit(rng) * 8.0f - 4.0f;
+                s.points.push_back({ x, y });
+            }
+            strokes.push_back(s);
+        }
+        return strokes;
+    }
+
+    inline std::vector<uint8_t> Encode(const std::vector<Stroke>& strokes) {
+        std::vector<uint8_t> out, payload;
+        std::vector<StrokeFormat::Style> styles;
+        StrokeFormat::PutHeader(out);
+        for (const Stroke& s : strokes)
+            StrokeFormat::PutStroke(out, styles, s, payload);
+        return out;
+    }
+
+    // What any decode must hold to, however damaged the input
+    inline bool Sane(const std::vector<Stroke>& strokes, size_t size) {
+        size_t points = 0;
+        for (const Stroke& s : strokes) {
+            points += s.points.size();
+            for (const Vector2& p : s.points)
+                if (!(fabsf(p.x) <= MaxCoordinate && fabsf(p.y) <= MaxCoordinate)) return false;
+        }
+        return points * 2 <= size;
+    }
+
+    // One stroke whose deltas each add 2^30 units, so a 32-bit running sum would wrap
+    inline std::vector<uint8_t> OverflowingStroke() {
+        std::vector<uint8_t> out, payload;
+        std::vector<StrokeFormat::Style> styles;
+        StrokeFormat::PutHeader(out);
+        Stroke seed = { { { 0.0f, 0.0f } }, WHITE, 5, false };
+        StrokeFormat::PutStroke(out, styles, seed, payload);
+
+        constexpr uint32_t Points = 16;
+        payload.clear();
+        StrokeFormat::PutVarint(payload, 0);
+        StrokeFormat::PutVarint(payload, Points);
+        for (uint32_t i = 0; i < Points * 2; i++)
+            StrokeFormat::PutVarint(payload, StrokeFormat::Zigzag(1 << 30));
+        out.push_back(StrokeFormat::RecordStroke);
+        StrokeFormat::PutVarint(out, (uint32_t)payload.size());
+        out.insert(out.end(), payload.begin(), payload.end());
+        return out;
+    }
+}
+
+inline int RunStrokeFuzz() {
+    using namespace StrokeFuzz;
+    int failures = 0;
+    std::mt19937 rng(5);
+
+    std::vector<Stroke> sample = MakeSample(rng);
+    std::vector<uint8_t> data = Encode(sample);
+    std::vector<Stroke> strokes;
+    std::vector<StrokeFormat::Style> styles;
+
+    // Round trip, within the quarter pixel the format keeps
+    float worst = 0.0f;
+    bool same = StrokeFormat::Decode(data.data(), data.size(), strokes, styles) && strokes.size() == sample.size();
+    for (size_t i = 0; same && i < strokes.size(); i++) {
+        same = strokes[i].points.size() == sample[i].points.size() && strokes[i].brushSize == sample[i].brushSize
+            && strokes[i].highlighter == sample[i].highlighter;
+        for (size_t k = 0; same && k < strokes[i].points.size(); k++)
+            worst = std::max({ worst, fabsf(strokes[i].points[k].x - sample[i].points[k].x),
+                fabsf(strokes[i].points[k].y - sample[i].points[k].y) });
+    }
+    bool roundTrip = same && worst <= 0.5f / StrokeFormat::Scale;
+    if (!roundTrip) failures++;
+    printf("Stroke document reader (%zu byte sample, %d strokes)\n", data.size(), SampleStrokes);
+    printf("  round trip : worst %.3f px %s\n", worst, roundTrip ? "ok" : "MISMATCH");
+
+    // Every cut keeps the whole strokes before it and never more
+    bool prefix = true;
+    size_t previous = 0;
+    for (size_t n = 0; n <= data.size(); n++) {
+        StrokeFormat::Decode(data.data(), n, strokes, styles);
+        if (strokes.size() < previous || strokes.size() > sample.size() || !Sane(strokes, n)) prefix = false;
+        previous = strokes.size();
+    }
+    if (!prefix || previous != sample.size()) failures++;
+    printf("  truncation : %zu cuts %s\n", data.size() + 1, prefix && previous == sample.size() ? "ok" : "FAILED");
+
+    // Deltas that run past the writer's range end the read instead of wrapping
+    std::vector<uint8_t> overflow = OverflowingStroke();
+    StrokeFormat::Decode(overflow.data(), overflow.size(), strokes, styles);
+    bool rejected = strokes.size() == 1 && Sane(strokes, overflow.size());
+    if (!rejected) failures++;
+    printf("  overflow   : %zu strokes kept %s\n", strokes.size(), rejected ? "ok" : "FAILED");
+
+    // Random damage: overwritten and flipped bytes, cuts, insertions, long varints
+    int broken = 0;
+    size_t mostStrokes = 0;
+    for (int it = 0; it < Iterations; it++) {
+        std::vector<uint8_t> damaged = data;
+        int mutations = 1 + (int)(rng() % 8);
+        for (int m = 0; m < mutations; m++) {
+            size_t at = rng() % damaged.size();
+            switch (rng() % 5) {
+            case 0: damaged[at] = (uint8_t)rng(); break;
+            case 1: damaged[at] ^= (uint8_t)(1 << (rng() % 8)); break;
+            case 2: damaged.resize(at); break;
+            case 3: damaged.insert(damaged.begin() + at, (uint8_t)rng()); break;
+            case 4: damaged.insert(damaged.begin() + at, 1 + rng() % 6, 0xff); break;
+            }
+            if (damaged.empty()) damaged.push_back(0);
+        }
+        StrokeFormat::Decode(damaged.data(), damaged.size(), strokes, styles);
+        if (!Sane(strokes, damaged.size())) broken++;
+        mostStrokes = std::max(mostStrokes, strokes.size());
+    }
+    if (broken > 0) failures++;
+    printf("  mutations  : %d runs, %d broken (most strokes %zu) %s\n", Iterations, broken, mostStrokes,
+        broken == 0 ? "ok" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
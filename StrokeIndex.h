@@ -0,0 +1,180 @@
+#pragma once
+#include "raylib_win32.h"
+#include "StrokeDocument.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Uniform grid over stroke segments, for hit tests and for finding what to redraw.
+//
+// Every segment between two kept points of a stroke goes into each cell it passes
+// near: the segment is widened by the brush radius plus a margin for the curve drawn
+// through the points, and walked one row of cells at a time. Strokes drawn zoomed far
+// out keep segments thousands of cells long, so the walk follows the segment instead of
+// filling its bounding box. A cell only holds the segments passing near it, so a query
+// looks at a handful of cells whatever the number of strokes. Cells are kept in a hash
+// map by position, made when first used and dropped when emptied, so the grid has no
+// edges, like the canvas.
+//
+// Strokes are named by Stroke::id rather than by position, because erasing and undo
+// move strokes around in the list.
+//--------------------------------------------------------------------------------------
+class StrokeIndex {
+public:
+    static constexpr int CellSize = 64;
+    static constexpr float CurveMargin = 2.0f; // the smoothed curve strays this far from the segments at most
+
+    void Clear() {
+        cells.clear();
+        entries = 0;
+    }
+
+    size_t Entries() const { return entries; }
+
+    void Add(const Stroke& stroke) {
+        float r = stroke.brushSize + CurveMargin;
+        ForEachSegment(stroke, [&](Vector2 a, Vector2 b) {
+            Entry e = { stroke.id, a.x, a.y, b.x, b.y, r };
+            ForEachCellNear(a, b, r, [&](uint64_t key) {
+                cells[key].push_back(e);
+                entries++;
+            });
+        });
+    }
+
+    void Remove(const Stroke& stroke) {
+        float r = stroke.brushSize + CurveMargin;
+        ForEachSegment(stroke, [&](Vector2 a, Vector2 b) {
+            ForEachCellNear(a, b, r, [&](uint64_t key) {
+                auto it = cells.find(key);
+                if (it == cells.end()) return;
+                std::vector<Entry>& cell = it->second;
+                for (size_t i = 0; i < cell.size(); i++) {
+                    if (cell[i].id != stroke.id) continue;
+                    cell[i] = cell.back();
+                    cell.pop_back();
+                    entries--;
+                    i--;
+                }
+                if (cell.empty()) cells.erase(it);
+            });
+        });
+    }
+
+    // Ids of strokes whose drawn area comes within `radius` of the path a -> b (the
+    // cursor's movement this frame), sorted and unique
+    void Hit(Vector2 a, Vector2 b, float radius, std::vector<uint32_t>& out) const {
+        out.clear();
+        ForEachCellNear(a, b, radius, [&](uint64_t key) {
+            auto it = cells.find(key);
+            if (it == cells.end()) return;
+            for (const Entry& e : it->second) {
+                float reach = e.r + radius;
+                if (SegmentDistance2(a, b, { e.ax, e.ay }, { e.bx, e.by }) <= reach * reach)
+                    out.push_back(e.id);
+            }
+        });
+        SortUnique(out);
+    }
+
+    // Ids of strokes that may draw inside the rectangle, sorted and unique
+    void Query(float x0, float y0, float x1, float y1, std::vector<uint32_t>& out) const {
+        out.clear();
+        ForEachCell(x0, y0, x1, y1, [&](const std::vector<Entry>& cell) {
+            for (const Entry& e : cell) {
+                if (std::max(e.ax, e.bx) + e.r < x0 || std::min(e.ax, e.bx) - e.r > x1) continue;
+                if (std::max(e.ay, e.by) + e.r < y0 || std::min(e.ay, e.by) - e.r > y1) continue;
+                out.push_back(e.id);
+            }
+        });
+        SortUnique(out);
+    }
+
+private:
+    struct Entry {
+        uint32_t id;
+        float ax, ay, bx, by;
+        float r;
+    };
+
+    template <typename Fn>
+    static void ForEachSegment(const Stroke& stroke, Fn fn) {
+        const auto& p = stroke.points;
+        if (p.size() == 1) fn(p[0], p[0]);
+        for (size_t i = 1; i < p.size(); i++) fn(p[i - 1], p[i]);
+    }
+
+    static uint64_t CellKey(int cx, int cy) {
+        return (uint64_t)(uint32_t)cx << 32 | (uint32_t)cy;
+    }
+
+    // Keys of the cells within r of segment ab. Each row of cells takes the part of the
+    // segment within r of the row, widened by r, so the cells visited grow with the
+    // segment's length rather than with its bounding box.
+    template <typename Fn>
+    static void ForEachCellNear(Vector2 a, Vector2 b, float r, Fn fn) {
+        const float dx = b.x - a.x, dy = b.y - a.y;
+        int cy0 = (int)floorf((std::min(a.y, b.y) - r) / CellSize);
+        int cy1 = (int)floorf((std::max(a.y, b.y) + r) / CellSize);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            float t0 = 0.0f, t1 = 1.0f;
+            if (dy != 0.0f) {
+                t0 = ((float)cy * CellSize - r - a.y) / dy;
+                t1 = ((float)(cy + 1) * CellSize + r - a.y) / dy;
+                if (t0 > t1) std::swap(t0, t1);
+                t0 = std::max(t0, 0.0f);
+                t1 = std::min(t1, 1.0f);
+                if (t0 > t1) continue;
+            }
+            float xa = a.x + dx * t0, xb = a.x + dx * t1;
+            int cx0 = (int)floorf((std::min(xa, xb) - r) / CellSize);
+            int cx1 = (int)floorf((std::max(xa, xb) + r) / CellSize);
+            for (int cx = cx0; cx <= cx1; cx++)
+                fn(CellKey(cx, cy));
+        }
+    }
+
+    // Rectangle queries visit the cells that exist in the box
+    template <typename Fn>
+    void ForEachCell(float x0, float y0, float x1, float y1, Fn fn) const {
+        int cx0 = (int)floorf(x0 / CellSize), cy0 = (int)floorf(y0 / CellSize);
+        int cx1 = (int)floorf(x1 / CellSize), cy1 = (int)floorf(y1 / CellSize);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                auto it = cells.find(CellKey(cx, cy));
+                if (it != cells.end()) fn(it->second);
+            }
+        }
+    }
+
+    static void SortUnique(std::vector<uint32_t>& ids) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    static float PointSegmentDistance2(Vector2 p, Vector2 a, Vector2 b) {
+        float dx = b.x - a.x, dy = b.y - a.y;
+        float len2 = dx * dx + dy * dy;
+        float t = len2 > 0.0f ? std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / len2, 0.0f, 1.0f) : 0.0f;
+        float ex = a.x + dx * t - p.x, ey = a.y + dy * t - p.y;
+        return ex * ex + ey * ey;
+    }
+
+    static float Cross(Vector2 o, Vector2 a, Vector2 b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+
+    // Squared distance between segments ab and cd; zero when they cross
+    static float SegmentDistance2(Vector2 a, Vector2 b, Vector2 c, Vector2 d) {
+        float d1 = Cross(c, d, a), d2 = Cross(c, d, b), d3 = Cross(a, b, c), d4 = Cross(a, b, d);
+        if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) return 0.0f;
+        return std::min(std::min(PointSegmentDistance2(a, c, d), PointSegmentDistance2(b, c, d)),
+            std::min(PointSegmentDistance2(c, a, b), PointSegmentDistance2(d, a, b)));
+    }
+
+    std::unordered_map<uint64_t, std::vector<Entry>> cells;
+    size_t entries = 0;
+};
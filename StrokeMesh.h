@@ -0,0 +1,189 @@
+#pragma once
+#include "raylib_win32.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Thick polyline geometry for drawing strokes.
+//
+// Each segment becomes a quad (two triangles) as wide as the brush. Joins and the ends
+// of a run get round fans whose arc length decides the number of triangles. A whole
+// polyline therefore costs a few triangles per input point, however far apart the
+// points are or however big the brush. The triangles are built on the CPU into one
+// list, and Draw() sends everything queued this frame in a single rlBegin/rlEnd.
+//
+// A run can continue a stroke that was drawn earlier. Its first point then already has
+// a full disc from the previous run, so the join there is round without being rebuilt.
+// Every run also ends in a full disc, which later serves as the join at that point.
+//
+// Each run keeps its bounding box, so drawing into one tile of a large canvas can skip
+// the runs that don't reach it.
+//--------------------------------------------------------------------------------------
+class StrokeMesh {
+public:
+    void Clear() {
+        vertices.clear();
+        spans.clear();
+    }
+
+    bool Empty() const { return vertices.empty(); }
+    size_t Triangles() const { return vertices.size() / 3; }
+
+    // Box around every run added since Clear()
+    Rectangle Bounds() const {
+        if (spans.empty()) return { 0, 0, 0, 0 };
+        float x0 = spans[0].x0, y0 = spans[0].y0, x1 = spans[0].x1, y1 = spans[0].y1;
+        for (const Span& span : spans) {
+            x0 = std::min(x0, span.x0); y0 = std::min(y0, span.y0);
+            x1 = std::max(x1, span.x1); y1 = std::max(y1, span.y1);
+        }
+        return { x0, y0, x1 - x0, y1 - y0 };
+    }
+
+    // Geometry for the segments ending at points[first..last]; first == 0 also caps the
+    // starting point. A one-point stroke comes out as a dot.
+    void AddRun(const std::vector<Vector2>& points, size_t first, size_t last, float radius, Color color) {
+        if (points.empty()) return;
+        last = std::min(last, points.size() - 1);
+        first = std::min(first, last);
+        SetRadius(radius);
+
+        if (first == 0) {
+            Disc(points[0]);
+            first = 1;
+        }
+
+        Vector2 prevDir = { 0, 0 };
+        bool havePrev = false;
+        for (size_t i = first; i <= last; i++) {
+            Vector2 a = points[i - 1];
+            Vector2 b = points[i];
+            float dx = b.x - a.x, dy = b.y - a.y;
+            float len = sqrtf(dx * dx + dy * dy);
+            if (len < 1e-3f) continue; // repeated sample, keeps the previous direction
+
+            Vector2 dir = { dx / len, dy / len };
+            Vector2 n = { -dir.y * radius, dir.x * radius };
+
+            if (havePrev) Join(a, prevDir, dir);
+
+            Vector2 al = { a.x + n.x, a.y + n.y }, ar = { a.x - n.x, a.y - n.y };
+            Vector2 bl = { b.x + n.x, b.y + n.y }, br = { b.x - n.x, b.y - n.y };
+            Triangle(al, ar, br);
+            Triangle(al, br, bl);
+
+            prevDir = dir;
+            havePrev = true;
+        }
+
+        if (last > 0) Disc(points[last]);
+        EndSpan(color);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // GPU side
+    //--------------------------------------------------------------------------------------
+    // One triangle batch for every run added since Clear(), each span in its own colour
+    void Draw() const { DrawSpans(nullptr); }
+
+    // Same, leaving out runs entirely outside `area`
+    void Draw(Rectangle area) const { DrawSpans(&area); }
+
+private:
+    void DrawSpans(const Rectangle* area) const {
+        if (vertices.empty()) return;
+
+        rlBegin(RL_TRIANGLES);
+        size_t v = 0;
+        for (const Span& span : spans) {
+            if (area && (span.x1 < area->x || span.x0 > area->x + area->width
+                || span.y1 < area->y || span.y0 > area->y + area->height)) {
+                v = span.end;
+                continue;
+            }
+            rlColor4ub(span.color.r, span.color.g, span.color.b, span.color.a);
+            for (; v < span.end; v++) rlVertex2f(vertices[v].x, vertices[v].y);
+        }
+        rlEnd();
+    }
+
+    struct Span {
+        size_t end;   // one past the span's last vertex
+        Color color;
+        float x0, y0, x1, y1;
+    };
+
+    // Chooses the fan step so the chord never strays more than a quarter pixel from
+    // the true circle
+    void SetRadius(float r) {
+        if (r == radius && !unit.empty()) return;
+        radius = r;
+
+        int segments = 8;
+        if (r > 0.25f) segments = (int)ceilf(PI / acosf(1.0f - 0.25f / r));
+        segments = std::clamp(segments, 8, 96);
+
+        step = 2.0f * PI / segments;
+        unit.resize(segments + 1);
+        for (int k = 0; k <= segments; k++)
+            unit[k] = { cosf(k * step), sinf(k * step) };
+    }
+
+    void Disc(Vector2 c) {
+        for (size_t k = 0; k + 1 < unit.size(); k++)
+            Triangle(c,
+                { c.x + unit[k].x * radius, c.y + unit[k].y * radius },
+                { c.x + unit[k + 1].x * radius, c.y + unit[k + 1].y * radius });
+    }
+
+    // Round join at c: fills the wedge on the outside of the turn from dir0 to dir1.
+    // The inside of the turn is already covered where the two quads overlap.
+    void Join(Vector2 c, Vector2 dir0, Vector2 dir1) {
+        float cross = dir0.x * dir1.y - dir0.y * dir1.x;
+        float dot = std::clamp(dir0.x * dir1.x + dir0.y * dir1.y, -1.0f, 1.0f);
+        float angle = acosf(dot);
+        if (angle < 1e-3f) return;
+
+        // Outer edge normals of both segments; the wedge sweeps from one to the other
+        float side = cross > 0.0f ? -radius : radius;
+        Vector2 from = { -dir0.y * side, dir0.x * side };
+        float turn = cross > 0.0f ? angle : -angle;
+
+        int steps = std::max(1, (int)ceilf(angle / step));
+        float s = sinf(turn / steps), co = cosf(turn / steps);
+        Vector2 p = from;
+        for (int k = 0; k < steps; k++) {
+            Vector2 q = { p.x * co - p.y * s, p.x * s + p.y * co };
+            Triangle(c, { c.x + p.x, c.y + p.y }, { c.x + q.x, c.y + q.y });
+            p = q;
+        }
+    }
+
+    // Stored in raylib's winding (counter-clockwise on screen) so back-face culling never
+    // drops part of a stroke
+    void Triangle(Vector2 a, Vector2 b, Vector2 c) {
+        float cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        vertices.push_back(a);
+        if (cross > 0.0f) { vertices.push_back(c); vertices.push_back(b); }
+        else { vertices.push_back(b); vertices.push_back(c); }
+    }
+
+    void EndSpan(Color color) {
+        size_t begin = spans.empty() ? 0 : spans.back().end;
+        if (begin == vertices.size()) return;
+
+        Span span = { vertices.size(), color, vertices[begin].x, vertices[begin].y, vertices[begin].x, vertices[begin].y };
+        for (size_t v = begin; v < vertices.size(); v++) {
+            span.x0 = std::min(span.x0, vertices[v].x); span.y0 = std::min(span.y0, vertices[v].y);
+            span.x1 = std::max(span.x1, vertices[v].x); span.y1 = std::max(span.y1, vertices[v].y);
+        }
+        spans.push_back(span);
+    }
+
+    std::vector<Vector2> vertices;  // triangle list
+    std::vector<Span> spans;
+    std::vector<Vector2> unit;      // unit circle at the current fan step
+    float radius = -1.0f;
+    float step = 1.0f;
+};
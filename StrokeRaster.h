@@ -0,0 +1,189 @@
+#pragma once
+#include "raylib_win32.h"
+#include "Simd.h"
+#include "StrokeDocument.h"
+#include "StrokeFilter.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Capsule coverage kernels: for one row of pixels, the anti-aliased coverage of the
+// capsule around segment a-b (radius r) is max-ed into `cov`. Coverage is the same
+// one-pixel ramp the flake atlas uses: clamp(r + 0.5 - distance, 0, 1), measured from
+// the pixel centre. Each kernel covers columns [x0, x1) of row y.
+//--------------------------------------------------------------------------------------
+struct CapsuleSegment {
+    float ax, ay;
+    float dx, dy;     // b - a
+    float invLen2;    // 1 / |b - a|^2, 0 for a dot
+    float r;
+};
+
+inline CapsuleSegment MakeCapsule(Vector2 a, Vector2 b, float r) {
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float len2 = dx * dx + dy * dy;
+    return { a.x, a.y, dx, dy, len2 > 1e-12f ? 1.0f / len2 : 0.0f, r };
+}
+
+// Scalar reference path, also used for the tail of the vector path
+inline void CapsuleCoverageScalar(float* cov, int x0, int x1, int y, const CapsuleSegment& s) {
+    float py = y + 0.5f - s.ay;
+    for (int x = x0; x < x1; x++) {
+        float px = x + 0.5f - s.ax;
+        float t = std::clamp((px * s.dx + py * s.dy) * s.invLen2, 0.0f, 1.0f);
+        float ex = px - s.dx * t, ey = py - s.dy * t;
+        float c = std::clamp(s.r + 0.5f - sqrtf(ex * ex + ey * ey), 0.0f, 1.0f);
+        cov[x] = std::max(cov[x], c);
+    }
+}
+
+// AVX2 path: eight pixels per iteration. Returns the column it stopped at.
+SIMD_TARGET_AVX2 inline int CapsuleCoverageAVX2(float* cov, int x0, int x1, int y, const CapsuleSegment& s) {
+    const __m256 lane = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 dx = _mm256_set1_ps(s.dx);
+    const __m256 dy = _mm256_set1_ps(s.dy);
+    const __m256 invLen2 = _mm256_set1_ps(s.invLen2);
+    const __m256 edge = _mm256_set1_ps(s.r + 0.5f);
+    const __m256 py = _mm256_set1_ps(y + 0.5f - s.ay);
+    const __m256 pyDy = _mm256_mul_ps(py, dy);
+
+    int x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        __m256 px = _mm256_add_ps(_mm256_set1_ps(x - s.ax), lane);
+        __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(px, dx), pyDy), invLen2);
+        t = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+        __m256 ex = _mm256_sub_ps(px, _mm256_mul_ps(dx, t));
+        __m256 ey = _mm256_sub_ps(py, _mm256_mul_ps(dy, t));
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)));
+        __m256 c = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(edge, dist), zero), one);
+        _mm256_storeu_ps(cov + x, _mm256_max_ps(_mm256_loadu_ps(cov + x), c));
+    }
+    return x;
+}
+
+inline void CapsuleCoverage(float* cov, int x0, int x1, int y, const CapsuleSegment& s) {
+    int done = CpuHasAVX2() ? CapsuleCoverageAVX2(cov, x0, x1, y, s) : x0;
+    CapsuleCoverageScalar(cov, done, x1, y, s);
+}
+
+//--------------------------------------------------------------------------------------
+// Software rasterizer for strokes, with no window or GPU involved.
+//
+// A stroke goes through the same Catmull-Rom curve as on screen. Every curve piece adds
+// its capsule to a float coverage buffer, taking the max so overlapping pieces never
+// double up. Then the stroke is blended into the RGBA pixels once, over its bounding
+// box. The blend is raylib's default alpha blend applied to all four channels, so the
+// result matches what the canvas render texture holds apart from edge anti-aliasing.
+// That makes it usable as a reference image for the GPU path as well as for export.
+//
+// A raster can also stand in for the highlighter layer (SetLayerBlend). Strokes there
+// are opaque, overlaps keep the larger alpha, and the layer is blended onto the image
+// once with DrawLayer().
+//--------------------------------------------------------------------------------------
+class StrokeRaster {
+public:
+    void Resize(int w, int h) {
+        width = std::max(w, 1);
+        height = std::max(h, 1);
+        pixels.assign((size_t)width * height, BLANK);
+        coverage.assign((size_t)width * height, 0.0f);
+    }
+
+    void Clear() { std::fill(pixels.begin(), pixels.end(), BLANK); }
+
+    // Alpha never adds up: each pixel keeps the largest coverage drawn into it
+    void SetLayerBlend(bool enabled) { layerBlend = enabled; }
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    const std::vector<Color>& Pixels() const { return pixels; }
+
+    void DrawStroke(const Stroke& stroke, Color color) {
+        if (stroke.points.empty()) return;
+        SmoothStroke(stroke.points.data(), stroke.points.size(), 0, stroke.points.size() - 1, curve);
+
+        float r = (float)stroke.brushSize;
+        int bx0 = width, by0 = height, bx1 = 0, by1 = 0; // stroke bounds, [x0, x1)
+        size_t pieces = std::max<size_t>(curve.size() - 1, 1); // a one-point stroke is a dot
+        for (size_t i = 0; i < pieces; i++) {
+            Vector2 a = curve[i];
+            Vector2 b = curve[std::min(i + 1, curve.size() - 1)];
+
+            int x0 = std::max(0, (int)floorf(std::min(a.x, b.x) - r - 1));
+            int y0 = std::max(0, (int)floorf(std::min(a.y, b.y) - r - 1));
+            int x1 = std::min(width, (int)ceilf(std::max(a.x, b.x) + r + 1));
+            int y1 = std::min(height, (int)ceilf(std::max(a.y, b.y) + r + 1));
+            if (x0 >= x1 || y0 >= y1) continue;
+
+            CapsuleSegment s = MakeCapsule(a, b, r);
+            for (int y = y0; y < y1; y++)
+                CapsuleCoverage(coverage.data() + (size_t)y * width, x0, x1, y, s);
+
+            bx0 = std::min(bx0, x0); by0 = std::min(by0, y0);
+            bx1 = std::max(bx1, x1); by1 = std::max(by1, y1);
+        }
+        Composite(color, bx0, by0, bx1, by1);
+    }
+
+    // Blends another raster of the same size over this one, scaled by `opacity`, as
+    // drawing its render texture with a Fade(WHITE, opacity) tint would
+    void DrawLayer(const StrokeRaster& layer, float opacity) {
+        if (layer.width != width || layer.height != height) return;
+        for (size_t i = 0; i < pixels.size(); i++) {
+            const Color& s = layer.pixels[i];
+            if (s.a == 0) continue;
+            Blend(pixels[i], s, s.a / 255.0f * opacity);
+        }
+    }
+
+    // PNG (or any format ExportImage knows) of the pixels
+    bool Export(const char* path) const {
+        Image image = { (void*)pixels.data(), width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        return ExportImage(image, path);
+    }
+
+private:
+    // Blends the stroke's coverage into the pixels and clears it for the next stroke
+    void Composite(Color color, int x0, int y0, int x1, int y1) {
+        const float alpha = color.a / 255.0f;
+        for (int y = y0; y < y1; y++) {
+            float* cov = coverage.data() + (size_t)y * width;
+            Color* dst = pixels.data() + (size_t)y * width;
+            for (int x = x0; x < x1; x++) {
+                if (cov[x] <= 0.0f) continue;
+                if (layerBlend) LayerBlend(dst[x], color, alpha * cov[x]);
+                else Blend(dst[x], color, alpha * cov[x]);
+                cov[x] = 0.0f;
+            }
+        }
+    }
+
+    // raylib's BLEND_ALPHA, alpha channel included
+    static void Blend(Color& d, Color s, float a) {
+        float keep = 1.0f - a;
+        d.r = (unsigned char)(s.r * a + d.r * keep + 0.5f);
+        d.g = (unsigned char)(s.g * a + d.g * keep + 0.5f);
+        d.b = (unsigned char)(s.b * a + d.b * keep + 0.5f);
+        d.a = (unsigned char)(255.0f * a * a + d.a * keep + 0.5f);
+    }
+
+    // Colour composited over what is there, alpha the max of the two
+    static void LayerBlend(Color& d, Color s, float a) {
+        float below = d.a / 255.0f * (1.0f - a);
+        float total = a + below;
+        if (total <= 0.0f) return;
+        d.r = (unsigned char)((s.r * a + d.r * below) / total + 0.5f);
+        d.g = (unsigned char)((s.g * a + d.g * below) / total + 0.5f);
+        d.b = (unsigned char)((s.b * a + d.b * below) / total + 0.5f);
+        d.a = std::max(d.a, (unsigned char)(255.0f * a + 0.5f));
+    }
+
+    int width = 1, height = 1;
+    bool layerBlend = false;
+    std::vector<Color> pixels;
+    std::vector<float> coverage;   // current stroke, cleared as it is composited
+    std::vector<Vector2> curve;    // scratch
+};
@@ -0,0 +1,333 @@
+#pragma once
+#include "raylib_win32.h"
+#include "StrokeMesh.h"
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Unbounded drawing surface made of tiles.
+//
+// World space is cut into 256x256 tiles. A tile is created the first time something
+// is drawn into it, with one render texture per layer. Above the tiles sits a mip
+// pyramid: a level L tile covers 2^L x 2^L tiles of level 0 at the same texture size.
+// It is built by drawing its four children at half size with bilinear filtering, which
+// averages each 2x2 block. A change to a level-0 tile only marks its ancestors stale,
+// and they are rebuilt the next time a view needs them. A zoomed-out view therefore
+// draws a screenful of coarse tiles and never reads the full-resolution ones.
+//
+// Tiles share a memory budget. Past it, the least recently used tiles are read back,
+// written to a spill directory and freed, and they are loaded again the next time
+// they're needed. A stale mip tile is just dropped, since it would be rebuilt anyway.
+// Tiles used during the current frame are never evicted, so a frame can go over.
+//
+// Render textures can't be created or bound while another one is bound, so tiles are
+// always acquired before any texture mode begins.
+//--------------------------------------------------------------------------------------
+class TiledCanvas {
+public:
+    static constexpr int TileSize = 256;
+    static constexpr int Layers = 2;    // ink, highlights
+    static constexpr int MaxLevel = 7;  // coarsest level; a tile there spans 32768 px
+    static constexpr size_t LayerBytes = (size_t)TileSize * TileSize * 4;
+
+    ~TiledCanvas() { Unload(); }
+
+    void Load(size_t memoryBytes, const std::filesystem::path& spillDirectory) {
+        Unload();
+        budget = memoryBytes;
+        spillDir = spillDirectory;
+        std::error_code ec;
+        std::filesystem::remove_all(spillDir, ec); // left over from an earlier run
+        std::filesystem::create_directories(spillDir, ec);
+    }
+
+    void Unload() {
+        Clear();
+        std::error_code ec;
+        if (!spillDir.empty()) std::filesystem::remove_all(spillDir, ec);
+    }
+
+    // Drops every tile
+    void Clear() {
+        for (auto& [key, tile] : tiles) {
+            if (tile.resident)
+                for (RenderTexture2D& layer : tile.layers) UnloadRenderTexture(layer);
+            if (tile.spilled) {
+                std::error_code ec;
+                std::filesystem::remove(SpillPath(key), ec);
+            }
+        }
+        tiles.clear();
+        lru.clear();
+        resident = 0;
+        spilled = 0;
+    }
+
+    // Tiles used from here on count as used this frame
+    void BeginFrame() { frame++; }
+
+    size_t Resident() const { return resident; }
+    size_t Spilled() const { return spilled; }
+
+    static uint64_t Key(int level, int x, int y) {
+        return (uint64_t)level << 60 | (uint64_t)((uint32_t)x & 0x3fffffff) << 30 | ((uint32_t)y & 0x3fffffff);
+    }
+
+    static int TileOf(float world, int level = 0) {
+        return (int)floorf(world / (float)(TileSize << level));
+    }
+
+    // Coarsest level that still has at least one texel per screen pixel
+    static int Level(float zoom) {
+        return std::clamp((int)floorf(-log2f(zoom) + 1e-3f), 0, MaxLevel);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Editing level 0
+    //--------------------------------------------------------------------------------------
+    // The layers of the level-0 tile (tx, ty), created or loaded back as needed
+    RenderTexture2D* Acquire(int tx, int ty) {
+        return Acquire(Key(0, tx, ty)).layers;
+    }
+
+    // Draws the mesh (in world coordinates) into every tile its runs reach
+    void Draw(int layer, const StrokeMesh& mesh) {
+        if (mesh.Empty()) return;
+        Rectangle b = mesh.Bounds();
+        ForEachTile(b, [&](int tx, int ty, Rectangle area) {
+            RenderTexture2D& target = Acquire(tx, ty)[layer];
+            BeginTextureMode(target);
+            rlPushMatrix();
+            rlTranslatef(-area.x, -area.y, 0.0f);
+            mesh.Draw(area);
+            rlPopMatrix();
+            EndTextureMode();
+            Changed(tx, ty);
+        });
+    }
+
+    // Clears `area` (world coordinates) and draws the mesh inside it only
+    void Redraw(int layer, Rectangle area, const StrokeMesh& mesh) {
+        ForEachTile(area, [&](int tx, int ty, Rectangle tileArea) {
+            float x0 = std::max(area.x, tileArea.x), y0 = std::max(area.y, tileArea.y);
+            float x1 = std::min(area.x + area.width, tileArea.x + TileSize), y1 = std::min(area.y + area.height, tileArea.y + TileSize);
+            if (x1 <= x0 || y1 <= y0) return;
+
+            RenderTexture2D& target = Acquire(tx, ty)[layer];
+            BeginTextureMode(target);
+            BeginScissorMode((int)(x0 - tileArea.x), (int)(y0 - tileArea.y), (int)(x1 - x0), (int)(y1 - y0));
+            ClearBackground({ 0,0,0,0 });
+            rlPushMatrix();
+            rlTranslatef(-tileArea.x, -tileArea.y, 0.0f);
+            mesh.Draw({ x0, y0, x1 - x0, y1 - y0 });
+            rlPopMatrix();
+            EndScissorMode();
+            EndTextureMode();
+            Changed(tx, ty);
+        });
+    }
+
+    // Marks the mip tiles above a changed level-0 tile as stale. Once a tile is stale
+    // so are all its ancestors, so the walk stops at the first one already marked.
+    void Changed(int tx, int ty) {
+        for (int level = 1; level <= MaxLevel; level++) {
+            tx >>= 1;
+            ty >>= 1;
+            Tile& parent = tiles[Key(level, tx, ty)];
+            if (parent.stale) return;
+            parent.stale = true;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Viewing
+    //--------------------------------------------------------------------------------------
+    // Brings the tiles a view will draw up to date: loads them and rebuilds stale mips.
+    // Call outside any texture or 2D mode, before DrawView().
+    void Prepare(const Camera2D& camera, int screenWidth, int screenHeight) {
+        int level = Level(camera.zoom);
+        ForEachVisible(camera, screenWidth, screenHeight, level, [&](int tx, int ty) {
+            auto it = tiles.find(Key(level, tx, ty));
+            if (it == tiles.end()) return;
+            if (it->second.stale) Build(level, tx, ty);
+            else Acquire(it->first);
+        });
+    }
+
+    // Draws one layer of the tiles in view; call inside BeginMode2D(camera)
+    void DrawView(int layer, const Camera2D& camera, int screenWidth, int screenHeight, Color tint) {
+        int level = Level(camera.zoom);
+        float size = (float)(TileSize << level);
+        ForEachVisible(camera, screenWidth, screenHeight, level, [&](int tx, int ty) {
+            auto it = tiles.find(Key(level, tx, ty));
+            if (it == tiles.end() || !it->second.resident) return;
+            DrawTexturePro(it->second.layers[layer].texture, { 0, 0, (float)TileSize, -(float)TileSize },
+                { tx * size, ty * size, size, size }, { 0, 0 }, 0.0f, tint);
+        });
+    }
+
+private:
+    struct Tile {
+        RenderTexture2D layers[Layers] = {};
+        bool resident = false;   // has its render textures
+        bool spilled = false;    // its pixels are in the spill directory
+        bool stale = false;      // mip tile whose children changed since it was built
+        uint64_t lastUse = 0;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    Tile& Acquire(uint64_t key) {
+        Tile& tile = tiles[key];
+        tile.lastUse = frame;
+        if (tile.resident) {
+            lru.splice(lru.begin(), lru, tile.lru);
+            return tile;
+        }
+
+        for (RenderTexture2D& layer : tile.layers) {
+            layer = LoadRenderTexture(TileSize, TileSize);
+            SetTextureFilter(layer.texture, TEXTURE_FILTER_BILINEAR);
+            BeginTextureMode(layer);
+            ClearBackground({ 0,0,0,0 });
+            EndTextureMode();
+        }
+        tile.resident = true;
+        resident++;
+        if (tile.spilled) ReadSpill(key, tile);
+        lru.push_front(key);
+        tile.lru = lru.begin();
+
+        Trim();
+        return tile;
+    }
+
+    // Evicts from the cold end until the budget holds or only this frame's tiles are left
+    void Trim() {
+        while (resident * LayerBytes * Layers > budget && !lru.empty()) {
+            uint64_t key = lru.back();
+            Tile& tile = tiles[key];
+            if (tile.lastUse == frame) return;
+            if (!tile.stale && !WriteSpill(key, tile)) return; // keep it rather than lose it
+
+            for (RenderTexture2D& layer : tile.layers) UnloadRenderTexture(layer);
+            tile.resident = false;
+            resident--;
+            lru.pop_back();
+        }
+    }
+
+    // Rebuilds a stale mip tile from its children, rebuilding stale children first. Each
+    // child is released once it's drawn in, so a deep rebuild only holds one path
+    // through the pyramid rather than everything under the tile.
+    void Build(int level, int tx, int ty) {
+        uint64_t key = Key(level, tx, ty);
+        Tile& tile = tiles[key];
+        if (tile.spilled) DropSpill(key, tile); // out of date
+        Acquire(key);
+        for (RenderTexture2D& layer : tile.layers) {
+            BeginTextureMode(layer);
+            ClearBackground({ 0,0,0,0 });
+            EndTextureMode();
+        }
+
+        const float half = TileSize / 2.0f;
+        for (int k = 0; k < 4; k++) {
+            uint64_t childKey = Key(level - 1, tx * 2 + (k & 1), ty * 2 + (k >> 1));
+            auto it = tiles.find(childKey);
+            if (it == tiles.end()) continue;
+            if (it->second.stale) Build(level - 1, tx * 2 + (k & 1), ty * 2 + (k >> 1));
+            Tile& child = Acquire(childKey);
+
+            for (int layer = 0; layer < Layers; layer++) {
+                BeginTextureMode(tile.layers[layer]);
+                rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD); // quadrants don't overlap: copy, alpha included
+                BeginBlendMode(BLEND_CUSTOM);
+                DrawTexturePro(child.layers[layer].texture, { 0, 0, (float)TileSize, -(float)TileSize },
+                    { (k & 1) * half, (k >> 1) * half, half, half }, { 0, 0 }, 0.0f, WHITE);
+                EndBlendMode();
+                EndTextureMode();
+            }
+            // Coldest again, so it can make room for the next one
+            child.lastUse = frame - 1;
+            lru.splice(lru.end(), lru, child.lru);
+        }
+        tile.stale = false;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Spill files: the raw texture storage of each layer, one after the other
+    //--------------------------------------------------------------------------------------
+    std::filesystem::path SpillPath(uint64_t key) const {
+        return spillDir / (std::to_string(key) + ".tile");
+    }
+
+    bool WriteSpill(uint64_t key, Tile& tile) {
+        std::ofstream out(SpillPath(key), std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        for (RenderTexture2D& layer : tile.layers) {
+            Image image = LoadImageFromTexture(layer.texture);
+            bool ok = image.data && image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+            if (ok) out.write((const char*)image.data, (std::streamsize)LayerBytes);
+            UnloadImage(image);
+            if (!ok || !out) return false;
+        }
+        if (!tile.spilled) spilled++;
+        tile.spilled = true;
+        return true;
+    }
+
+    void ReadSpill(uint64_t key, Tile& tile) {
+        std::ifstream in(SpillPath(key), std::ios::binary);
+        std::vector<uint8_t> data(LayerBytes);
+        for (RenderTexture2D& layer : tile.layers) {
+            if (!in.read((char*)data.data(), (std::streamsize)LayerBytes)) break;
+            UpdateTexture(layer.texture, data.data());
+        }
+    }
+
+    void DropSpill(uint64_t key, Tile& tile) {
+        std::error_code ec;
+        std::filesystem::remove(SpillPath(key), ec);
+        tile.spilled = false;
+        spilled--;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Tile ranges
+    //--------------------------------------------------------------------------------------
+    // Level-0 tiles overlapping the world rectangle, with each tile's own area
+    template <typename Fn>
+    static void ForEachTile(Rectangle r, Fn fn) {
+        int tx0 = TileOf(r.x), ty0 = TileOf(r.y);
+        int tx1 = TileOf(r.x + r.width), ty1 = TileOf(r.y + r.height);
+        for (int ty = ty0; ty <= ty1; ty++)
+            for (int tx = tx0; tx <= tx1; tx++)
+                fn(tx, ty, Rectangle{ (float)(tx * TileSize), (float)(ty * TileSize), (float)TileSize, (float)TileSize });
+    }
+
+    template <typename Fn>
+    static void ForEachVisible(const Camera2D& camera, int screenWidth, int screenHeight, int level, Fn fn) {
+        Vector2 a = GetScreenToWorld2D({ 0, 0 }, camera);
+        Vector2 b = GetScreenToWorld2D({ (float)screenWidth, (float)screenHeight }, camera);
+        int tx0 = TileOf(a.x, level), ty0 = TileOf(a.y, level);
+        int tx1 = TileOf(b.x, level), ty1 = TileOf(b.y, level);
+        for (int ty = ty0; ty <= ty1; ty++)
+            for (int tx = tx0; tx <= tx1; tx++)
+                fn(tx, ty);
+    }
+
+    std::unordered_map<uint64_t, Tile> tiles;
+    std::list<uint64_t> lru;     // resident tiles, most recently used first
+    size_t resident = 0;
+    size_t spilled = 0;
+    size_t budget = 0;
+    uint64_t frame = 0;
+    std::filesystem::path spillDir;
+};
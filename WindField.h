@@ -0,0 +1,106 @@
+#pragma once
+#include "raylib_win32.h"
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+// Low resolution 2D wind field for the snow.
+//
+// Node velocities are the curl of a slowly drifting value-noise potential, so the flow
+// is divergence-free: flakes swirl around eddies instead of bunching up or thinning
+// out. The grid is only rebuilt a few times per second and sampled bilinearly.
+//--------------------------------------------------------------------------------------
+class WindField {
+public:
+    int cols = 0;
+    int rows = 0;
+    float cellSize = 64.0f;
+
+    // Node velocities, row-major (rows * cols). Same units as the old scalar windForce.
+    std::vector<float> u;
+    std::vector<float> v;
+
+    void Resize(int width, int height, float cell) {
+        cellSize = std::max(cell, 8.0f);
+        cols = (int)ceilf(width / cellSize) + 1;
+        rows = (int)ceilf(height / cellSize) + 1;
+        u.assign((size_t)cols * rows, 0.0f);
+        v.assign((size_t)cols * rows, 0.0f);
+        potential.assign((size_t)(cols + 2) * (rows + 2), 0.0f);
+    }
+
+    void Update(double time, float strength) {
+        if (cols == 0) return;
+
+        const float featureCells = 4.0f;      // eddy size in grid cells
+        const float z = (float)(time * 0.15); // how fast the pattern evolves
+        const int pw = cols + 2;
+
+        for (int j = 0; j < rows + 2; j++) {
+            for (int i = 0; i < pw; i++) {
+                float nx = (i - 1) / featureCells;
+                float ny = (j - 1) / featureCells;
+                potential[(size_t)j * pw + i] =
+                    ValueNoise(nx, ny, z) + 0.5f * ValueNoise(nx * 2.0f, ny * 2.0f, z * 2.0f);
+            }
+        }
+
+        // Central differences of the potential; the vertical part is damped so gusts
+        // push flakes sideways more than they lift them.
+        const float k = strength * featureCells;
+        for (int j = 0; j < rows; j++) {
+            for (int i = 0; i < cols; i++) {
+                const float* p = &potential[(size_t)(j + 1) * pw + (i + 1)];
+                size_t n = (size_t)j * cols + i;
+                u[n] = (p[pw] - p[-pw]) * 0.5f * k;
+                v[n] = -(p[1] - p[-1]) * 0.5f * k * 0.25f;
+            }
+        }
+    }
+
+    // Scalar bilinear lookup; the SIMD integrators do the same math eight lanes at a time
+    Vector2 Sample(float x, float y) const {
+        float gx = std::clamp(x / cellSize, 0.0f, cols - 1.001f);
+        float gy = std::clamp(y / cellSize, 0.0f, rows - 1.001f);
+        int i = (int)gx, j = (int)gy;
+        float fx = gx - i, fy = gy - j;
+        size_t n = (size_t)j * cols + i;
+
+        float u0 = u[n] + (u[n + 1] - u[n]) * fx;
+        float u1 = u[n + cols] + (u[n + cols + 1] - u[n + cols]) * fx;
+        float v0 = v[n] + (v[n + 1] - v[n]) * fx;
+        float v1 = v[n + cols] + (v[n + cols + 1] - v[n + cols]) * fx;
+        return { u0 + (u1 - u0) * fy, v0 + (v1 - v0) * fy };
+    }
+
+private:
+    std::vector<float> potential; // (rows + 2) * (cols + 2), one node of border
+
+    static float Hash(int x, int y, int z) {
+        uint32_t h = (uint32_t)x * 374761393u + (uint32_t)y * 668265263u + (uint32_t)z * 2147483647u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        h ^= h >> 16;
+        return (h & 0xFFFFFF) / (float)0xFFFFFF * 2.0f - 1.0f;
+    }
+
+    static float ValueNoise(float x, float y, float z) {
+        int x0 = (int)floorf(x), y0 = (int)floorf(y), z0 = (int)floorf(z);
+        float fx = x - x0, fy = y - y0, fz = z - z0;
+        fx = fx * fx * (3.0f - 2.0f * fx);
+        fy = fy * fy * (3.0f - 2.0f * fy);
+        fz = fz * fz * (3.0f - 2.0f * fz);
+
+        auto plane = [&](int zi) {
+            float a = Hash(x0, y0, zi), b = Hash(x0 + 1, y0, zi);
+            float c = Hash(x0, y0 + 1, zi), d = Hash(x0 + 1, y0 + 1, zi);
+            float top = a + (b - a) * fx;
+            float bottom = c + (d - c) * fx;
+            return top + (bottom - top) * fy;
+        };
+
+        float p0 = plane(z0), p1 = plane(z0 + 1);
+        return p0 + (p1 - p0) * fz;
+    }
+};
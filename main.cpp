@@ -1,5 +1,6 @@
 #define NOMINMAX
 #include "raylib_win32.h"
+#include "Helper.h"
 #include <random>
 #include <string>
 #include "Config.h"
@@ -7,6 +8,10 @@
 #include "SnowSimulation.h"
 #include "FireworksSimulation.h"
 #include "DrawingSimulation.h"
+#include "SparkBenchmark.h"
+#include "GlowBenchmark.h"
+#include "StrokeExport.h"
+#include "StrokeFuzz.h"
 
 // Random generator
 std::random_device rd;
@@ -15,7 +20,27 @@ std::uniform_real_distribution<float> dist01(0.0f, 1.0f);
 
 ConfigManager configManager;
 
-int main() {
+int main(int argc, char** argv) {
+    // Headless command-line modes
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench-sparks") == 0) {
+            AttachParentConsole();
+            return RunSparkBenchmark();
+        }
+        if (strcmp(argv[i], "--bench-glow") == 0) {
+            AttachParentConsole();
+            return RunGlowBenchmark();
+        }
+        if (strcmp(argv[i], "--fuzz-doc") == 0) {
+            AttachParentConsole();
+            return RunStrokeFuzz();
+        }
+        if (strcmp(argv[i], "--export") == 0 && i + 2 < argc) {
+            AttachParentConsole();
+            return RunStrokeExport(argv[i + 1], argv[i + 2]);
+        }
+    }
+
     Config* config = configManager.GetConfig();
     GlobalHotkey hotkey;
 
@@ -28,7 +53,7 @@ int main() {
     int screenHeight = GetMonitorHeight(display) - 1;
 	SetWindowSize(screenWidth, screenHeight);
     SetWindowPosition((int)monitorPos.x, (int)monitorPos.y);
-    SetTargetFPS(60);
+    SetTargetFPS(config->TargetFPS);
 
     HideFromTaskbar();
 	SetWindowTopMost(config->TopMost);
@@ -106,6 +131,7 @@ int main() {
         }
 
         bool isControlDown = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+        ISimulation* previous = sim.get();
 
 		if (isControlDown && IsKeyPressed(KEY_ONE))
 		{
@@ -147,6 +173,11 @@ int main() {
 				sim = std::make_unique<DrawingSimulation>(config->DrawingSimConfig);
 		}
 
+        if (sim.get() != previous) {
+            previous->OnDeactivate();
+            sim->OnActivate();
+        }
+
         EndDrawing();
     }
 